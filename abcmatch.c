@@ -1137,19 +1137,20 @@ void startfile(); /* links with matchsup.c */
 int
 analyze_abc_file (char *filename)
 {
-  FILE *fp;
-  fp = fopen (filename, "rt");
-  if (fp == NULL)
+  struct abcbuffer source;
+  int t;
+  if (openabcbuffer (filename, &source) == 0)
     {
       printf ("cannot open file %s\n", filename);
       exit (0);
     }
   init_histograms ();
-  while (!feof (fp))
+  t = 0;
+  while (t != EOF)
     {
       fileindex++;
       startfile ();
-      parsetune (fp);
+      t = parsetune (&source);
 /*     printf("fileindex = %d xrefno =%d\n",fileindex,xrefno); */
 /*     printf("%s\n",titlename); */
       if (notes < 10)
@@ -1175,7 +1176,7 @@ analyze_abc_file (char *filename)
 	}
 
     }
-  fclose (fp);
+  freeabcbuffer (&source);
   switch (action)
     {
     case cpitch_histogram:
@@ -1401,6 +1402,8 @@ main (int argc, char *argv[])
    */
 
   int kfile, count;
+  struct abcbuffer source;
+  int t;
   int kount;
 
 /* initialization */
@@ -1468,19 +1471,19 @@ main (int argc, char *argv[])
 
 
       xmatch = 0; /* we do not want to filter any reference numbers here */
-      fp = fopen (filename, "rt");
-      if (fp == NULL)
+      if (openabcbuffer (filename, &source) == 0)
 	{
 	  printf ("cannot open file %s\n", filename);
 	  exit (0);
 	}
 
       kfile = 0;
-      while (!feof (fp))
+      t = 0;
+      while (t != EOF)
 	{
 	  fileindex++;
 	  startfile ();
-	  parsetune (fp);
+	  t = parsetune (&source);
           /*printf("fileindex = %d xrefno =%d\n",fileindex,xrefno); 
             printf("%s\n",titlename); */
           if (tpxref == xrefno) {
@@ -1538,7 +1541,7 @@ main (int argc, char *argv[])
 					       anymode, con);
 	    }
 	}
-      fclose (fp);
+      freeabcbuffer (&source);
       if (tpxref > 0) {
           printf ("%d %d ", tp_fileindex, tpxref);
           for (i = 0; i <tpbars ;i++) 
@@ -89,6 +89,7 @@ extern int *charloc; /* [SS] 2014-12-25 */
 extern featuretype *feature;
 extern int *stressvelocity; /* [SS] 2011-08-17 */
 extern int notes;
+extern int ntexts; /* [SS] 2026-10-18 */
 extern int barflymode; /* [SS] 2011-08-24 */
 extern int stressmodel; /* [SS] 2011-08-26 */
 extern int programbase; /* [SS] 2017-06-02 */
@@ -259,12 +260,15 @@ int bendnvals;
 int bendtype = 1;
 
 /* [SS] 2015-07-24 2015-10-03 */
-#define MAXLAYERS 3
 int controldata[MAXLAYERS][256];
 int controlnvals[MAXLAYERS];
 int controldefaults[128]; /* [SS] 2015-08-10 */
 int nlayers = 0; /* [SS] 2015-08-20 */
 int controlcombo = 0; /* [SS] 2015-08-20 */
+/* [SS] 2026-10-18 incremented whenever benddata, bendnvals,  */
+/* controldata, controlnvals or nlayers change. note_effect5() */
+/* in queues.c uses it to tell when its envelopes are stale.   */
+int envelope_generation = 0;
 
 
 /* for handling stress models */
@@ -347,6 +351,109 @@ void addunits(int a, int b)
   /*printf("position = %d/%d\n",bar_num,bar_denom);*/
 }
 
+/* [SS] 2026-10-18 The accompaniment pattern is compiled together with */
+/* the current chord into a template holding, for each step of the     */
+/* gchord string, the notes to be played. dogchords() only plays the   */
+/* template. The template is rebuilt when the pattern, the chord or the */
+/* bass/chord settings change.                                         */
+struct templatenote {
+  int pitch;
+  int chan;
+  int vel;
+};
+
+struct gchordstep {
+  char action;   /* code from the gchord string */
+  int len;
+  int nnotes;
+  struct templatenote note[8];
+};
+
+static struct gchordstep gchord_template[40];
+static int gchord_seqlen = 0;      /* strlen(gchord_seq) */
+static int gchord_template_valid = 0;
+static int drum_seqlen = 0;        /* strlen(drum_seq) */
+
+static void addtemplatenote(struct gchordstep *step, int pitch, struct notetype *voice)
+{
+  step->note[step->nnotes].pitch = pitch;
+  step->note[step->nnotes].chan = voice->chan;
+  step->note[step->nnotes].vel = voice->vel;
+  step->nnotes = step->nnotes + 1;
+}
+
+static void compile_gchord_template()
+/* works out the notes played at each step of gchord_seq for the */
+/* current chord, in the same way as the original dogchords().   */
+{
+  int i, j;
+  char action;
+  struct gchordstep *step;
+
+  for (i=0; i<gchord_seqlen || i==0; i++) {
+    step = &gchord_template[i];
+    action = gchord_seq[i];
+    step->len = gchord_len[i];
+    step->nnotes = 0;
+    if ((chordnum == -1) && (action == 'c')) {
+      action = 'f';
+    };
+    step->action = action;
+    switch (action) {
+    case 'f':
+    case 'b':
+      /* do fundamental */
+      if (inversion == -1)
+        addtemplatenote(step, basepitch+fun.base, &fun);
+      else
+        addtemplatenote(step, inversion+fun.base, &fun);
+      if (action == 'f') break;
+      /* 'b' continues with the chord */
+    case 'c':
+      for (j=0; j<gchordnotes_size; j++)
+        addtemplatenote(step, gchordnotes[j], &gchord);
+      break;
+    case 'g':
+    case 'h':
+    case 'i':
+    case 'j':
+    case 'k':
+      j = action - 'g';
+      if (gchordnotes_size > j)
+        addtemplatenote(step, gchordnotes[j], &gchord);
+      else
+        addtemplatenote(step, gchordnotes[gchordnotes_size], &gchord);
+      if (action != 'k') break;
+      /* 'k' has always continued into 'G' */
+      j = 0;
+      if (gchordnotes_size > j)
+        addtemplatenote(step, gchordnotes[j]-12, &gchord);
+      else
+        addtemplatenote(step, gchordnotes[gchordnotes_size], &gchord);
+      break;
+    case 'G':
+    case 'H':
+    case 'I':
+    case 'J':
+      j = action - 'G';
+      if (gchordnotes_size > j)
+        addtemplatenote(step, gchordnotes[j]-12, &gchord);
+      else
+        addtemplatenote(step, gchordnotes[gchordnotes_size], &gchord);
+      break;
+    case 'K':
+      if (gchordnotes_size > 3)
+        addtemplatenote(step, gchordnotes[4]-12, &gchord);
+      else
+        addtemplatenote(step, gchordnotes[gchordnotes_size], &gchord);
+      break;
+    default:
+      break;
+    };
+  };
+  gchord_template_valid = 1;
+}
+
 void configure_gchord()
 /* creates a list of notes to played as chord for
  * a specific guitar chord. Most of the code figures out
@@ -357,6 +464,7 @@ void configure_gchord()
  int inchord, note;
 
  gchordnotes_size = 0;
+ gchord_template_valid = 0; /* [SS] 2026-10-18 */
  if (chordnum < 0) return; /* [SS] 2022-03-20 */
 
 inchord = 0;
@@ -419,6 +527,8 @@ void set_gchords(char *s)
     seq_len = 1;
   };
   gchord_seq[j] = '\0';
+  gchord_seqlen = j; /* [SS] 2026-10-18 */
+  gchord_template_valid = 0;
   if (j == 39) {
     event_error("Sequence string too long");
   };
@@ -456,6 +566,7 @@ void set_drums(char *s)
     count = count + 1;
   };
   drum_seq[count] = '\0';
+  drum_seqlen = count; /* [SS] 2026-10-18 */
   if (seq_len == 0) {
     event_error("Bad drum sequence");
     drum_seq[0] = 'z';
@@ -661,32 +772,154 @@ static int partbreak(int xtrack, int voice, int place)
   return(newplace);
 }
 
-static int findvoice(int initplace, int voice, int xtrack)
-/* find where next occurrence of correct voice is */
+/* [SS] 2026-10-18 findvoice() used to scan the feature table one
+ * entry at a time, so every track of a multi-voice tune looked at the
+ * features of all the other voices. index_voices() records, for each
+ * voice, the positions of its VOICE features together with all the
+ * PART features, and the position of the last LINENUM before every
+ * feature, so that findvoice() can go straight to the next stop.
+ */
+static int **voicestops = NULL;  /* positions for each voice number */
+static int *nvoicestops = NULL;
+static int nindexedvoices = 0;   /* voice numbers 0..nindexedvoices-1 */
+static int *partstops = NULL;    /* PART positions, for other voices */
+static int npartstops = 0;
+static int *lastlinenum = NULL;  /* last LINENUM before each position */
+static int *sectionstop = NULL;  /* next section end or VOICE, see below */
+
+void index_voices()
+/* builds the index used by findvoice(). Called from finishfile() */
+/* in store.c once the feature table is complete.                 */
 {
-  int foundvoice;
-  int j;
+  int j, v;
 
-  foundvoice = 0;
-  j = initplace;
-  while ((j < notes) && (foundvoice == 0)) {
-    if (feature[j] == LINENUM) { /* [SS] 2019-03-14 */
-      lineno = pitch[j];
-      }
+  nindexedvoices = 1;
+  npartstops = 0;
+  for (j=0; j<notes; j++) {
+    if ((feature[j] == VOICE) && (pitch[j] >= nindexedvoices)) {
+      nindexedvoices = pitch[j] + 1;
+    };
+    if (feature[j] == PART) npartstops++;
+  };
+  nvoicestops = (int*) checkmalloc(nindexedvoices*sizeof(int));
+  voicestops = (int**) checkmalloc(nindexedvoices*sizeof(int*));
+  for (v=0; v<nindexedvoices; v++) nvoicestops[v] = npartstops;
+  for (j=0; j<notes; j++) {
+    if ((feature[j] == VOICE) && (pitch[j] >= 0)) nvoicestops[pitch[j]]++;
+  };
+  for (v=0; v<nindexedvoices; v++) {
+    voicestops[v] = (int*) checkmalloc((nvoicestops[v]+1)*sizeof(int));
+    nvoicestops[v] = 0;
+  };
+  partstops = (int*) checkmalloc((npartstops+1)*sizeof(int));
+  npartstops = 0;
+  lastlinenum = (int*) checkmalloc((notes+1)*sizeof(int));
+  sectionstop = (int*) checkmalloc((notes+1)*sizeof(int));
+  lastlinenum[0] = -1;
+  for (j=0; j<notes; j++) {
     if (feature[j] == PART) {
-      j = partbreak(xtrack, voice, j);
-      if (voice == 1) {
-        foundvoice = 1;
-      } else {
-        j = j + 1;
+      partstops[npartstops++] = j;
+      for (v=0; v<nindexedvoices; v++) {
+        voicestops[v][nvoicestops[v]++] = j;
       };
+    };
+    if ((feature[j] == VOICE) && (pitch[j] >= 0)) {
+      v = pitch[j];
+      voicestops[v][nvoicestops[v]++] = j;
+    };
+    if (feature[j] == LINENUM) {
+      lastlinenum[j+1] = j;
     } else {
-      if ((feature[j] == VOICE) && (pitch[j] == voice)) {
-        foundvoice = 1;
-      } else {
-        j = j + 1;
-      };
+      lastlinenum[j+1] = lastlinenum[j];
+    };
+  };
+  /* [SS] 2026-10-18 sectionstop[j] is the first position >= j which  */
+  /* can end a variant ending that is not being played, or a VOICE    */
+  /* feature. writetrack() uses it to jump over the skipped ending.   */
+  sectionstop[notes] = notes;
+  for (j=notes-1; j>=0; j--) {
+    switch (feature[j]) {
+      case REP_BAR:
+      case BAR_REP:
+      case PART:
+      case DOUBLE_BAR:
+      case THICK_THIN:
+      case THIN_THICK:
+      case PLAY_ON_REP:
+      case VOICE:
+        sectionstop[j] = j;
+        break;
+      default:
+        sectionstop[j] = sectionstop[j+1];
+    };
+  };
+}
+
+void free_voice_index()
+/* releases the index built by index_voices() */
+{
+  int v;
+
+  for (v=0; v<nindexedvoices; v++) free(voicestops[v]);
+  if (voicestops != NULL) free(voicestops);
+  if (nvoicestops != NULL) free(nvoicestops);
+  if (partstops != NULL) free(partstops);
+  if (lastlinenum != NULL) free(lastlinenum);
+  if (sectionstop != NULL) free(sectionstop);
+  voicestops = NULL;
+  nvoicestops = NULL;
+  partstops = NULL;
+  lastlinenum = NULL;
+  sectionstop = NULL;
+  nindexedvoices = 0;
+  npartstops = 0;
+}
+
+static int nextvoicestop(int place, int voice)
+/* returns the first position >= place holding a PART feature or */
+/* a VOICE feature for voice, or notes if there is none.          */
+{
+  int *stops;
+  int nstops, lo, hi, mid;
+
+  if ((voice >= 0) && (voice < nindexedvoices)) {
+    stops = voicestops[voice];
+    nstops = nvoicestops[voice];
+  } else {
+    stops = partstops;
+    nstops = npartstops;
+  };
+  lo = 0;
+  hi = nstops;
+  while (lo < hi) {
+    mid = (lo + hi)/2;
+    if (stops[mid] < place) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    };
+  };
+  if (lo == nstops) return(notes);
+  return(stops[lo]);
+}
+
+static int findvoice(int initplace, int voice, int xtrack)
+/* find where next occurrence of correct voice is */
+{
+  int j, stop;
+
+  j = initplace;
+  while (j < notes) {
+    stop = nextvoicestop(j, voice);
+    /* keep lineno as though the features had been scanned [SS] 2019-03-14 */
+    if (lastlinenum[stop] >= j) {
+      lineno = pitch[lastlinenum[stop]];
     };
+    if (stop == notes) return(notes);
+    if (feature[stop] != PART) return(stop);
+    j = partbreak(xtrack, voice, stop);
+    if (voice == 1) return(j);
+    j = j + 1;
   };
   return(j);
 }
@@ -1316,9 +1549,6 @@ static void midi_noteon(long delta_time, int pitch, int pitchbend, int chan, int
 /* write note on event to MIDI file */
 {
   char data[2];
-#ifdef NOFTELL
-  extern int nullpass;
-#endif
   if (channel >= MAXCHANS) {
     event_error("Channel limit exceeded");
   } else {
@@ -1661,29 +1891,6 @@ void write_event(int event_type, int channel, char data[], int n)
   };
 }
 
-static char *select_channel(int *chan, char *s)
-/* used by dodeferred() to set channel to be used */
-/* reads 'bass', 'chord' or nothing from string pointed to by p */
-{
-  char sel[40];
-  char *p;
-
-  p = s;
-  skipspace(&p);
-  *chan = channel;
-  if (isalpha(*p)) {
-    readstr(sel, &p, 40);
-    skipspace(&p);
-    if (strcmp(sel, "bass") == 0) {
-      *chan = fun.chan;
-    };
-    if (strcmp(sel, "chord") == 0) {
-      *chan = gchord.chan;
-    };
-  };
-  return(p);
-}
-
 static int makechordchannels (int n)
 {
 /* Allocate channels for in voice chords containing microtones.
@@ -1876,7 +2083,304 @@ for (i = 0; i< size; i++) {
 }
 
 
-static void dodeferred(char *s, int noteson)
+/* [SS] 2026-10-18 the %%MIDI command words in strcmp order */
+static struct midicommandname {
+  char *name;
+  int code;
+} midicommands[] = {
+  {"C", MIDI_C},
+  {"barlines", MIDI_BARLINES},
+  {"bassprog", MIDI_BASSPROG},
+  {"bassvol", MIDI_BASSVOL},
+  {"beat", MIDI_BEAT},
+  {"beataccents", MIDI_BEATACCENTS},
+  {"beatmod", MIDI_BEATMOD},
+  {"beatstring", MIDI_BEATSTRING},
+  {"bendstring", MIDI_BENDSTRING},
+  {"bendstringex", MIDI_BENDSTRINGEX},
+  {"bendvelocity", MIDI_BENDVELOCITY},
+  {"channel", MIDI_CHANNEL},
+  {"chordattack", MIDI_CHORDATTACK},
+  {"chordname", MIDI_CHORDNAME},
+  {"chordprog", MIDI_CHORDPROG},
+  {"chordvol", MIDI_CHORDVOL},
+  {"control", MIDI_CONTROL},
+  {"controlcombo", MIDI_CONTROLCOMBO},
+  {"controlstring", MIDI_CONTROLSTRING},
+  {"deltaloudness", MIDI_DELTALOUDNESS},
+  {"drone", MIDI_DRONE},
+  {"droneoff", MIDI_DRONEOFF},
+  {"droneon", MIDI_DRONEON},
+  {"drum", MIDI_DRUM},
+  {"drumbars", MIDI_DRUMBARS},
+  {"drummap", MIDI_DRUMMAP},
+  {"drumoff", MIDI_DRUMOFF},
+  {"drumon", MIDI_DRUMON},
+  {"expand", MIDI_EXPAND},
+  {"fermatafixed", MIDI_FERMATAFIXED},
+  {"fermataproportional", MIDI_FERMATAPROPORTIONAL},
+  {"gchord", MIDI_GCHORD},
+  {"gchordbars", MIDI_GCHORDBARS},
+  {"gchordoff", MIDI_GCHORDOFF},
+  {"gchordon", MIDI_GCHORDON},
+  {"grace", MIDI_GRACE},
+  {"gracedivider", MIDI_GRACEDIVIDER},
+  {"harpmode", MIDI_HARPMODE},
+  {"makechordchannels", MIDI_MAKECHORDCHANNELS},
+  {"nobarlines", MIDI_NOBARLINES},
+  {"nobeataccents", MIDI_NOBEATACCENTS},
+  {"noportamento", MIDI_NOPORTAMENTO},
+  {"pitchbend", MIDI_PITCHBEND},
+  {"pitchbendrange", MIDI_PITCHBENDRANGE},
+  {"portamento", MIDI_PORTAMENTO},
+  {"program", MIDI_PROGRAM},
+  {"programbase", MIDI_PROGRAMBASE},
+  {"ptstress", MIDI_PTSTRESS},
+  {"randomchordattack", MIDI_RANDOMCHORDATTACK},
+  {"ratio", MIDI_RATIO},
+  {"rtranspose", MIDI_RTRANSPOSE},
+  {"snt", MIDI_SNT},
+  {"stressmodel", MIDI_STRESSMODEL},
+  {"temperamentequal", MIDI_TEMPERAMENTEQUAL},
+  {"temperamentlinear", MIDI_TEMPERAMENTLINEAR},
+  {"temperamentnormal", MIDI_TEMPERAMENTNORMAL},
+  {"transpose", MIDI_TRANSPOSE},
+  {"trim", MIDI_TRIM},
+  {"tuningsystem", MIDI_TUNINGSYSTEM},
+  {"vol", MIDI_VOL},
+  {"volinc", MIDI_VOLINC}
+};
+
+static int compare_midicommand(const void *key, const void *entry)
+{
+  return strcmp((char *) key, ((struct midicommandname *) entry)->name);
+}
+
+int midi_command_code(char *name)
+/* returns the MIDI_ code for a %%MIDI command word or MIDI_UNKNOWN */
+{
+  struct midicommandname *found;
+
+  found = (struct midicommandname *) bsearch(name, midicommands,
+    sizeof(midicommands)/sizeof(struct midicommandname),
+    sizeof(struct midicommandname), compare_midicommand);
+  if (found == NULL) return MIDI_UNKNOWN;
+  return found->code;
+}
+
+/* [SS] 2026-10-18 The deferred %%MIDI directives (DYNAMIC features)
+ * are parsed once by compile_deferred() before the tracks are written.
+ * Each one becomes a deferredcmd record holding the command code and
+ * its integer arguments, and dodeferred() works from the record, so a
+ * directive replayed on every track and repeat is not parsed again.
+ * Directives which take text (gchord, drum, beatstring, snt, drummap)
+ * keep a pointer to the text following the command word.
+ */
+struct deferredcmd {
+  int code;     /* MIDI_ code of the command word */
+  int nargs;
+  int *args;    /* integer arguments, see compile_deferred_command() */
+  char *text;   /* the complete directive */
+  char *rest;   /* text after the command word */
+};
+
+static struct deferredcmd *deferred = NULL;
+static int ndeferred = 0;
+
+static int read_channel_selector(char **p)
+/* reads 'bass', 'chord' or nothing from the string pointed to by p */
+/* and returns 1, 2 or 0 respectively. See selected_channel().     */
+{
+  char sel[40];
+  int selector;
+
+  skipspace(p);
+  selector = 0;
+  if (isalpha(**p)) {
+    readstr(sel, p, 40);
+    skipspace(p);
+    if (strcmp(sel, "bass") == 0) {
+      selector = 1;
+    };
+    if (strcmp(sel, "chord") == 0) {
+      selector = 2;
+    };
+  };
+  return(selector);
+}
+
+static int selected_channel(int selector)
+/* used by dodeferred() to set channel to be used */
+{
+  if (selector == 1) return(fun.chan);
+  if (selector == 2) return(gchord.chan);
+  return(channel);
+}
+
+static void compile_deferred_command(char *s, struct deferredcmd *d)
+/* parses the deferred %%MIDI directive s into d */
+{
+  char* p;
+  char *q;
+  char command[40];
+  int buf[256];
+  int bendinput[64]; /* [SS] 2020-08-09 */
+  int n, i, octave;
+
+  p = s;
+  skipspace(&p);
+  readstr(command, &p, 40);
+  d->code = midi_command_code(command);
+  skipspace(&p);
+  d->text = s;
+  d->rest = p;
+  n = 0;
+  switch (d->code) {
+    case MIDI_MAKECHORDCHANNELS:
+    case MIDI_DRUMBARS:
+    case MIDI_GCHORDBARS:
+    case MIDI_CHORDVOL:
+    case MIDI_BASSVOL:
+    case MIDI_CHORDATTACK:
+    case MIDI_RANDOMCHORDATTACK:
+    case MIDI_VOL:
+      skipspace(&p);
+      buf[n++] = readnump(&p);
+      break;
+    case MIDI_PITCHBENDRANGE:
+    case MIDI_VOLINC:
+    case MIDI_BEATMOD:
+      skipspace(&p);
+      buf[n++] = readsnump(&p);
+      break;
+    case MIDI_PROGRAM:
+      /* prog or chan prog */
+      skipspace(&p);
+      buf[n++] = readnump(&p);
+      skipspace(&p);
+      if ((*p >= '0') && (*p <= '9')) {
+        buf[n++] = readnump(&p);
+      };
+      break;
+    case MIDI_CHORDPROG:
+    case MIDI_BASSPROG:
+      /* prog, octave= present, octave valid, octave */
+      buf[0] = readnump(&p);
+      buf[1] = 0;
+      buf[2] = 0;
+      buf[3] = 0;
+      q = strstr(p,"octave="); /* [SS] 2011-11-18 */
+      if (q != 0) {
+        buf[1] = 1;
+        if (sscanf(q+7,"%d",&octave) == 1 && octave > -3 && octave < 3) {
+          buf[2] = 1;
+          buf[3] = octave;
+        };
+      };
+      n = 4;
+      break;
+    case MIDI_BENDVELOCITY:
+      /* velocity, acceleration, number of values */
+      for (i=0; i<3; i++) {
+        skipspace(&p);
+        buf[n++] = readsnump(&p);
+      };
+      break;
+    case MIDI_BENDSTRING:
+    case MIDI_CONTROLSTRING:
+      while (n<256) { /* [SS] 2015-09-10 2015-10-03 */
+        buf[n++] = readsnump(&p);
+        skipspace(&p);
+        /* [SS] 2015-08-31 */
+        if (*p == 0) break;
+      };
+      break;
+    case MIDI_BENDSTRINGEX:
+      /* the values are expanded here rather than each time */
+      i = 0;
+      while (i<64) { /* [SS] 2020-08-09 2015-09-10 2015-10-03 */
+        bendinput[i] = readsnump(&p);
+        skipspace(&p);
+        i = i + 1;
+        if (*p == 0) break;
+      };
+      expand_array (bendinput, i, buf, 4);
+      n = i*4;
+      break;
+    case MIDI_DRONE:
+    case MIDI_BEAT:
+      for (i=0; i<((d->code == MIDI_DRONE) ? 5 : 4); i++) {
+        skipspace(&p);
+        buf[n++] = readnump(&p);
+      };
+      break;
+    case MIDI_CONTROL:
+      /* channel selector followed by up to 20 data bytes */
+      buf[n++] = read_channel_selector(&p);
+      while ((n<21) && (*p >= '0') && (*p <= '9')) {
+        buf[n++] = readnump(&p);
+        skipspace(&p);
+      };
+      break;
+    case MIDI_PITCHBEND:
+      buf[n++] = read_channel_selector(&p);
+      while ((n<3) && (*p >= '0') && (*p <= '9')) {
+        buf[n++] = readnump(&p);
+        skipspace(&p);
+      };
+      break;
+    case MIDI_PORTAMENTO:
+      buf[n++] = read_channel_selector(&p);
+      buf[n++] = readnump(&p);
+      break;
+    case MIDI_NOPORTAMENTO:
+      buf[n++] = read_channel_selector(&p);
+      break;
+    default:
+      break;
+  };
+  d->nargs = n;
+  d->args = NULL;
+  if (n > 0) {
+    d->args = (int*) checkmalloc(n*sizeof(int));
+    for (i=0; i<n; i++) d->args[i] = buf[i];
+  };
+}
+
+void compile_deferred()
+/* parses all the deferred %%MIDI directives of the tune */
+/* called from finishfile() in store.c before writing tracks */
+{
+  int j;
+
+  ndeferred = ntexts;
+  if (ndeferred == 0) return;
+  deferred = (struct deferredcmd*) checkmalloc(ndeferred*sizeof(struct deferredcmd));
+  for (j=0; j<ndeferred; j++) {
+    deferred[j].text = NULL;
+    deferred[j].args = NULL;
+  };
+  for (j=0; j<notes; j++) {
+    if ((feature[j] == DYNAMIC) && (deferred[pitch[j]].text == NULL)) {
+      compile_deferred_command(atext[pitch[j]], &deferred[pitch[j]]);
+    };
+  };
+}
+
+void free_deferred()
+/* releases the records made by compile_deferred() */
+{
+  int j;
+
+  for (j=0; j<ndeferred; j++) {
+    if (deferred[j].args != NULL) free(deferred[j].args);
+  };
+  if (deferred != NULL) free(deferred);
+  deferred = NULL;
+  ndeferred = 0;
+}
+
+static void dodeferred(struct deferredcmd *d, int noteson)
 /* handle package-specific command which has been held over to be */
 /* interpreted as MIDI is being generated */
 {
@@ -1884,36 +2388,37 @@ static void dodeferred(char *s, int noteson)
   char command[40];
   /* char inputfile[256];  [SS] 2011-07-04 [SDG] 2020-06-04*/
   int done;
+  int code;
+  int *arg;
   int val;
   int i;
-  int bendinput[64]; /* [SS] 2020-08-09 */
 
-  p = s;
-  skipspace(&p);
-  readstr(command, &p, 40);
-  skipspace(&p);
+  code = d->code;
+  arg = d->args;
+  p = d->rest;
   done = 0;
 
-  if (verbose>1)
-       printf("dodeferred: track = %d cmd = %s\n",tracknumber,command);
-
-  if (strcmp(command,"makechordchannels") == 0) {
+  if (verbose>1) {
+    p = d->text;
     skipspace(&p);
-    val = readnump(&p);
-    makechordchannels(val);
+    readstr(command, &p, 40);
+    p = d->rest;
+    printf("dodeferred: track = %d cmd = %s\n",tracknumber,command);
+  };
+
+  if (code == MIDI_MAKECHORDCHANNELS) {
+    makechordchannels(arg[0]);
     done = 1;
     } 
 
-  else if (strcmp(command, "program") == 0) {
+  else if (code == MIDI_PROGRAM) {
     int chan, prog;
 
-    skipspace(&p);
-    prog = readnump(&p);
+    prog = arg[0];
     chan = channel;
-    skipspace(&p);
-    if ((*p >= '0') && (*p <= '9')) {
+    if (d->nargs == 2) {
       chan = prog - 1;
-      prog = readnump(&p);
+      prog = arg[1];
     };
     if (noteson) {
       current_program[chan] = prog;
@@ -1922,98 +2427,82 @@ static void dodeferred(char *s, int noteson)
     done = 1;
   }
 
-  else if (strcmp(command, "gchord") == 0) {
+  else if (code == MIDI_GCHORD) {
     set_gchords(p);
     done = 1;
   }
 
-  else if (strcmp(command, "drum") == 0) {
+  else if (code == MIDI_DRUM) {
     set_drums(p);
     done = 1;
   }
 
-  else if ((strcmp(command, "drumbars") == 0)) {
-     drumbars = readnump(&p);
+  else if ((code == MIDI_DRUMBARS)) {
+     drumbars = arg[0];
      if (drumbars < 1 || drumbars > 10) drumbars = 1;
      done = 1;
      drum_ptr = 0; /* [SS] 2018-06-23 */
      addtoQ(0,drum_denom,-1,drum_ptr,0,0);
      }
 
-  else if ((strcmp(command, "gchordbars") == 0)) {
-     gchordbars = readnump(&p);
+  else if ((code == MIDI_GCHORDBARS)) {
+     gchordbars = arg[0];
      if (gchordbars < 1 || gchordbars > 10) gchordbars = 1;
      done = 1;
      g_ptr = 0; /* [SS] 2018-06-23 */
      addtoQ(0, g_denom, -1, g_ptr ,0, 0);
      }
 
-  else if ((strcmp(command, "chordprog") == 0))  {
-    int prog;
-
-    prog = readnump(&p);
+  else if ((code == MIDI_CHORDPROG))  {
     if (gchordson) {
-      write_program(prog, gchord.chan);
+      write_program(arg[0], gchord.chan);
       /* [SS] 2011-11-18 */
-      p = strstr(p,"octave=");
-      if (p != 0)
-                      {int octave,found;
-                       p = p+7;
-                       found = sscanf(p,"%d",&octave);
-                       if (found == 1 && octave > -3 && octave < 3) gchord.base = 48 + 12*octave;
-                       printf("gchord.base = %d\n",gchord.base);
-                       }
+      if (arg[1]) {
+        if (arg[2]) gchord.base = 48 + 12*arg[3];
+        gchord_template_valid = 0; /* [SS] 2026-10-18 */
+        printf("gchord.base = %d\n",gchord.base);
+        }
     };
     done = 1;
   }
 
-  else if ((strcmp(command, "bassprog") == 0)) {
-    int prog;
-
-    prog = readnump(&p);
+  else if ((code == MIDI_BASSPROG)) {
     if (gchordson) {
-      write_program(prog, fun.chan);
+      write_program(arg[0], fun.chan);
       /* [SS] 2011-11-18 */
-      p = strstr(p,"octave=");
-      if (p != 0)
-                      {int octave,found;
-                       p = p+7;
-                       found = sscanf(p,"%d",&octave);
-                       if (found == 1 && octave > -3 && octave < 3) fun.base = 36 + 12*octave;
-                       printf("fun.base = %d\n",fun.base);
-                       }
+      if (arg[1]) {
+        if (arg[2]) fun.base = 36 + 12*arg[3];
+        gchord_template_valid = 0; /* [SS] 2026-10-18 */
+        printf("fun.base = %d\n",fun.base);
+        }
     };
     done = 1;
   }
 
-  else if (strcmp(command, "chordvol") == 0) {
-    gchord.vel = readnump(&p);
+  else if (code == MIDI_CHORDVOL) {
+    gchord.vel = arg[0];
+    gchord_template_valid = 0; /* [SS] 2026-10-18 */
     done = 1;
   }
 
-  else if (strcmp(command, "bassvol") == 0) {
-    fun.vel = readnump(&p);
+  else if (code == MIDI_BASSVOL) {
+    fun.vel = arg[0];
+    gchord_template_valid = 0; /* [SS] 2026-10-18 */
     done = 1;
   }
 
 
   /* [SS] 2012-12-12 */
-  else if (strcmp(command, "bendvelocity") == 0) {
+  else if (code == MIDI_BENDVELOCITY) {
 /* We use bendstring code so that bendvelocity integrates with !shape!.
    Bends a note along the shape of a parabola. The note is
    split into 8 segments. Given the bendacceleration and
    initial bend velocity, the new pitch bend is computed
    for each time segment.
 */
-    bendvelocity = bendacceleration = 0;
-    skipspace(&p);
-    val = readsnump(&p);
-    bendvelocity = val;
-    skipspace(&p);
-    val = readsnump(&p);
-    bendacceleration = val;
-    skipspace(&p); /* [SS] 2022-02-13 */
-    val = readsnump(&p);
+    bendvelocity = arg[0];
+    bendacceleration = arg[1];
+    val = arg[2]; /* [SS] 2022-02-13 */
     if (val > 0 && val < 100) bendnvals = val; 
     else bendnvals = 8;
 
@@ -2027,66 +2516,34 @@ static void dodeferred(char *s, int noteson)
     /*bendtype = 1; [SS] 2015-08-11 */
     if (bendnvals == 1) bendtype = 3; /* [SS] 2014-09-22 */
     else bendtype = 2;
+    envelope_generation++;
     done = 1;
     }
 
   /* [SS] 2014-09-10 */
-  else if (strcmp(command, "bendstring") == 0) {
-     i = 0;
-     while (i<256) { /* [SS] 2015-09-10 2015-10-03 */
-          benddata[i] = readsnump(&p);
-          skipspace(&p);
-          i = i + 1;
-          /* [SS] 2015-08-31 */
-          if (*p == 0) break;
-        };
-     bendnvals = i;
+  /* bendstringex was expanded by compile_deferred_command() */
+  else if (code == MIDI_BENDSTRING || code == MIDI_BENDSTRINGEX) {
+     for (i=0; i<d->nargs; i++) benddata[i] = arg[i];
+     bendnvals = d->nargs;
+     envelope_generation++;
      done = 1;
      if (bendnvals == 1) bendtype = 3; /* [SS] 2014-09-22 */
      else bendtype = 2;
      }
 
-  /* [SS] 2014-09-10 */
-  else if (strcmp(command, "bendstringex") == 0) {
-     i = 0;
-     while (i<64) { /* [SS] 2020-08-09 2015-09-10 2015-10-03 */
-          bendinput[i] = readsnump(&p);
-          skipspace(&p);
-          i = i + 1;
-          if (*p == 0) break;
-        };
-     expand_array (bendinput, i, benddata, 4);
-     bendnvals = i*4;
-     done = 1;
-     if (bendnvals == 1) bendtype = 3;
-     else bendtype = 2;
-     }
-
   /* [SS] 2022-01-27 */
-  else if (strcmp(command, "pitchbendrange") == 0) {
-     int semis;
-     semis = readsnump(&p);
-     midiPitchBendRange(semis);
+  else if (code == MIDI_PITCHBENDRANGE) {
+     midiPitchBendRange(arg[0]);
      done = 1;
      }
 
 
-  else if (strcmp(command, "drone") == 0) {
-    skipspace(&p);
-    val = readnump(&p);
-    if (val > 0) drone.prog = val;
-    skipspace(&p);
-    val = readnump(&p);
-    if (val >0 ) drone.pitch1 = val;
-    skipspace(&p);
-    val = readnump(&p);
-    if (val >0)  drone.pitch2 = val;
-    skipspace(&p);
-    val = readnump(&p);
-    if (val >0) drone.vel1 = val;
-    skipspace(&p);
-    val = readnump(&p);
-    if (val >0) drone.vel2 = val;
+  else if (code == MIDI_DRONE) {
+    if (arg[0] > 0) drone.prog = arg[0];
+    if (arg[1] > 0) drone.pitch1 = arg[1];
+    if (arg[2] > 0) drone.pitch2 = arg[2];
+    if (arg[3] > 0) drone.vel1 = arg[3];
+    if (arg[4] > 0) drone.vel2 = arg[4];
     if (drone.prog > 127) event_error("drone prog must be in the range 0-127");
     if (drone.pitch1 >127) event_error("drone pitch1 must be in the range 0-127");
     if (drone.vel1 >127) event_error("drone vel1 must be in the range 0-127");
@@ -2095,24 +2552,19 @@ static void dodeferred(char *s, int noteson)
     done = 1;
   }
 
-  else if (strcmp(command, "beat") == 0) {
-    skipspace(&p);
-    loudnote = readnump(&p);
-    skipspace(&p);
-    mednote = readnump(&p);
-    skipspace(&p);
-    softnote = readnump(&p);
-    skipspace(&p);
-    beat = readnump(&p);
+  else if (code == MIDI_BEAT) {
+    loudnote = arg[0];
+    mednote = arg[1];
+    softnote = arg[2];
+    beat = arg[3];
     if (beat == 0) {
       beat = barsize;
     };
     done = 1;
   }
 
-  else if (strcmp(command, "beatmod") == 0) {
-    skipspace(&p);
-    velocity_increment = readsnump(&p);
+  else if (code == MIDI_BEATMOD) {
+    velocity_increment = arg[0];
     loudnote += velocity_increment;
     mednote  += velocity_increment;
     softnote += velocity_increment;
@@ -2125,10 +2577,9 @@ static void dodeferred(char *s, int noteson)
     done = 1;
     }
 
-  else if (strcmp(command, "beatstring") == 0) {
+  else if (code == MIDI_BEATSTRING) {
     int count;
 
-    skipspace(&p);
     count = 0;
     while ((count < 99) && (strchr("fFmMpP", *p) != NULL)) {
       beatstring[count] = *p;
@@ -2143,21 +2594,18 @@ static void dodeferred(char *s, int noteson)
     done = 1;
   }
 
-  else if (strcmp(command, "control") == 0) {
+  else if (code == MIDI_CONTROL) {
     int chan, n, datum;
     char data[20];
 
-    p = select_channel(&chan, p);
-    n = 0;
-    while ((n<20) && (*p >= '0') && (*p <= '9')) {
-      datum = readnump(&p);
+    chan = selected_channel(arg[0]);
+    for (n=0; n<d->nargs-1; n++) {
+      datum = arg[n+1];
       if (datum > 127) {
         event_error("data must be in the range 0 - 127");
         datum = 0;
       };
       data[n] = (char) datum;
-      n = n + 1;
-      skipspace(&p);
     };
     write_event(control_change, chan, data, n);
     controldefaults[(int) data[0]] = (int) data[1]; /* [SS] 2015-08-10 */
@@ -2166,22 +2614,17 @@ static void dodeferred(char *s, int noteson)
 
 
   /* [SS] 2015-07-24 */
-  else if (strcmp(command, "controlstring") == 0) {
+  else if (code == MIDI_CONTROLSTRING) {
+     envelope_generation++;
      if (!controlcombo) { /* [SS] 2015-08-20 */
         for (i=0;i<MAXLAYERS;i++) controlnvals[i] = 0;
         nlayers = 0;  /* overwrite layer 0 if not a combo */
         }
-     i = 0;
      if (nlayers >= MAXLAYERS) {
         event_error("too many combos for control data");
         } else {
-        while (i<256) { /* [SS] 2015-09-10  2015-10-03 */
-          controldata[nlayers][i] = readsnump(&p);
-          skipspace(&p);
-          i = i + 1;
-          if (*p == 0) break;
-          }
-        controlnvals[nlayers] = i;
+        for (i=0; i<d->nargs; i++) controldata[nlayers][i] = arg[i];
+        controlnvals[nlayers] = d->nargs;
         /* [SS] 2015-08-23 */
         if (controlnvals[nlayers] < 2) event_error("empty %%MIDI controlstring"); 
         controlcombo = 0; /* turn off controlcombo */
@@ -2190,33 +2633,34 @@ static void dodeferred(char *s, int noteson)
      }
 
   /* [SS] 2015-08-20 */
-  else if (strcmp(command, "controlcombo") == 0) {
+  else if (code == MIDI_CONTROLCOMBO) {
      controlcombo = 1;
      nlayers++;
+     envelope_generation++;
      done = 1;
      }
 
-  else if( strcmp(command, "beataccents") == 0) {
+  else if( code == MIDI_BEATACCENTS) {
     beataccents = 1;
     beatmodel = 0; /* [SS] 2011-07-04 */
     done = 1;
   }
 
-  else if( strcmp(command, "nobeataccents") == 0) {
+  else if( code == MIDI_NOBEATACCENTS) {
     beataccents = 0;
     done = 1;
   }
 
-  else if (strcmp(command,"portamento") == 0) {
+  else if (code == MIDI_PORTAMENTO) {
    int chan, datum;
    char data[4];
-   p = select_channel(&chan, p);
+   chan = selected_channel(arg[0]);
    data[0] = 65;
    data[1] = 127;
    /* turn portamento on */
    write_event(control_change, chan, data, 2);
    data[0] = 5; /* coarse portamento */
-   datum = readnump(&p);
+   datum = arg[1];
    if (datum > 63) {
         event_error("data must be in the range 0 - 63");
         datum = 0;
@@ -2226,10 +2670,10 @@ static void dodeferred(char *s, int noteson)
    done = 1;
    } 
 
-  else if (strcmp(command,"noportamento") == 0) {
+  else if (code == MIDI_NOPORTAMENTO) {
    int chan;
    char data[4];
-   p = select_channel(&chan, p);
+   chan = selected_channel(arg[0]);
    data[0] = 65;
    data[1] = 0;
    /* turn portamento off */
@@ -2237,23 +2681,20 @@ static void dodeferred(char *s, int noteson)
    done = 1;
    }
 
-  else if (strcmp(command, "pitchbend") == 0) {
+  else if (code == MIDI_PITCHBEND) {
     int chan, n, datum;
     char data[2];
 
-    p = select_channel(&chan, p);
-    n = 0;
+    chan = selected_channel(arg[0]);
     data[0] = 0;
     data[1] = 0;
-    while ((n<2) && (*p >= '0') && (*p <= '9')) {
-      datum = readnump(&p);
+    for (n=0; n<d->nargs-1; n++) {
+      datum = arg[n+1];
       if (datum > 255) {
         event_error("data must be in the range 0 - 255");
         datum = 0;
       };
       data[n] = (char) datum;
-      n = n + 1;
-      skipspace(&p);
     };
 /* don't write pitchbend in the header track [SS] 2005-04-02 */
     if (noteson) {
@@ -2264,7 +2705,7 @@ static void dodeferred(char *s, int noteson)
     done = 1;
   }
 
-  else if (strcmp(command, "snt") == 0) {  /*single note tuning */
+  else if (code == MIDI_SNT) {  /*single note tuning */
     int midikey;
     float midipitch;
     midikey = readnump(&p);
@@ -2274,44 +2715,47 @@ static void dodeferred(char *s, int noteson)
     }
    
 
-  else if (strcmp(command,"chordattack") == 0) {
-    staticnotedelay = readnump(&p);
+  else if (code == MIDI_CHORDATTACK) {
+    staticnotedelay = arg[0];
     notedelay = staticnotedelay;
     done = 1;
   }
 
-  else if (strcmp(command,"randomchordattack") == 0) {
-    staticchordattack = readnump(&p);
+  else if (code == MIDI_RANDOMCHORDATTACK) {
+    staticchordattack = arg[0];
     chordattack = staticchordattack;
     done = 1;
   }
 
-  else if (strcmp(command,"drummap") == 0) {
+  else if (code == MIDI_DRUMMAP) {
     parse_drummap(&p);
     done = 1;
   }
 
   /* [SS] 2018-04-16 ptstress code moved to event_midi() in store.c */
 
-  else if (strcmp(command,"stressmodel") == 0) { /* [SS] 2011-08-19 */
+  else if (code == MIDI_STRESSMODEL) { /* [SS] 2011-08-19 */
     if (barflymode == 0) 
         printf("**warning stressmodel is ignored without -BF runtime option\n");
     done = 1;
     }
 
   /* [SS] 2015-09-08 */
-  else if (strcmp(command,"volinc") == 0) {
-      single_velocity_inc = readsnump(&p);
+  else if (code == MIDI_VOLINC) {
+      single_velocity_inc = arg[0];
       done = 1;
       }
 
-  else if (strcmp(command,"vol") == 0) {
-      single_velocity = readnump(&p);
+  else if (code == MIDI_VOL) {
+      single_velocity = arg[0];
       done = 1;
       }
 
   if (done == 0) {
     char errmsg[80];
+    p = d->text;
+    skipspace(&p);
+    readstr(command, &p, 40);
     sprintf(errmsg, "%%%%MIDI command \"%s\" not recognized",command);
     event_error(errmsg);
   };
@@ -2349,143 +2793,42 @@ static void save_note(int num, int denom, int pitch, int pitchbend, int chan, in
 void dogchords(int i)
 /* generate accompaniment notes */
 /* note no microtone or linear temperament support ! */
+/* [SS] 2026-10-18 plays the compiled template, see compile_gchord_template() */
 {
 int j;
-  if (g_ptr >= (int) strlen(gchord_seq)) g_ptr = 0;
+  if (g_ptr >= gchord_seqlen) g_ptr = 0;
   if (i == g_ptr) {  /* [SS] 2018-06-23 */
     int len;
-    char action;
-
-    action = gchord_seq[g_ptr];
-    len = gchord_len[g_ptr];
-    if ((chordnum == -1) && (action == 'c')) {
-      action = 'f';
-    };
-    if (gchords && g_started) /* [SS] 2021-06-27 2023-12-29*/
-    switch (action) {
-
-    case 'z':
-      break;
-
-    case 'f':
-        /* do fundamental */
-        if (inversion == -1)
-        save_note(g_num*len, g_denom, basepitch+fun.base, 8192, fun.chan, fun.vel);
-        else
-        save_note(g_num*len, g_denom, inversion+fun.base, 8192, fun.chan, fun.vel);
-      break;
-
-    case 'b':
-        /* do fundamental */
-        if (inversion == -1)  /* [SS] 2014-11-02 */
-        save_note(g_num*len, g_denom, basepitch+fun.base, 8192, fun.chan, fun.vel);
-        else
-        save_note(g_num*len, g_denom, inversion+fun.base, 8192, fun.chan, fun.vel);
-      /* break;  * [SS] 2021-06-27 2021-09-15 */
-/* There should not be a break here so the switch statement continues into the next case 'c' */ 
-
-    case 'c':
-      /* do chord with handling of any 'inversion' note */
-      if (g_started && gchords) {
-          for(j=0;j<gchordnotes_size;j++)
-          save_note(g_num*len, g_denom, gchordnotes[j], 8192,
-		    gchord.chan, gchord.vel);
-        };
-      break;
-
-    case 'g':
-      if(gchordnotes_size>0)
-        save_note(g_num*len, g_denom, gchordnotes[0], 8192, gchord.chan, gchord.vel); 
-      else /* [SS] 2016-01-03 */
-        save_note(g_num*len, g_denom, gchordnotes[gchordnotes_size], 8192, gchord.chan, gchord.vel); 
-      break;
-
-    case 'h':
-      if(gchordnotes_size >1)
-        save_note(g_num*len, g_denom, gchordnotes[1], 8192, gchord.chan, gchord.vel); 
-      else /* [SS] 2016-01-03 */
-        save_note(g_num*len, g_denom, gchordnotes[gchordnotes_size], 8192, gchord.chan, gchord.vel); 
-      break;
-
-    case 'i':
-      if(gchordnotes_size >2)
-        save_note(g_num*len, g_denom, gchordnotes[2], 8192, gchord.chan, gchord.vel); 
-      else /* [SS] 2016-01-03 */
-        save_note(g_num*len, g_denom, gchordnotes[gchordnotes_size], 8192, gchord.chan, gchord.vel); 
-      break;
-
-    case 'j':
-      if(gchordnotes_size >3)
-        save_note(g_num*len, g_denom, gchordnotes[3], 8192, gchord.chan, gchord.vel); 
-      else /* [SS] 2016-01-03 */
-        save_note(g_num*len, g_denom, gchordnotes[gchordnotes_size], 8192, gchord.chan, gchord.vel); 
-      break;
-
-    /* [SS] 2021-12-10 */
-    case 'k':
-      if(gchordnotes_size >4)
-        save_note(g_num*len, g_denom, gchordnotes[4], 8192, gchord.chan, gchord.vel); 
-      else /* [SS] 2016-01-03 */
-        save_note(g_num*len, g_denom, gchordnotes[gchordnotes_size], 8192, gchord.chan, gchord.vel); 
-
-    case 'G':
-      if(gchordnotes_size>0 )
-        save_note(g_num*len, g_denom, gchordnotes[0]-12, 8192, gchord.chan, gchord.vel); 
-      else /* [SS] 2016-01-03 */
-        save_note(g_num*len, g_denom, gchordnotes[gchordnotes_size], 8192, gchord.chan, gchord.vel); 
-      break;
-
-    case 'H':
-      if(gchordnotes_size >1)
-        save_note(g_num*len, g_denom, gchordnotes[1]-12, 8192, gchord.chan, gchord.vel); 
-      else /* [SS] 2016-01-03 */
-        save_note(g_num*len, g_denom, gchordnotes[gchordnotes_size], 8192, gchord.chan, gchord.vel); 
-      break;
-
-    case 'I':
-      if(gchordnotes_size >2)
-        save_note(g_num*len, g_denom, gchordnotes[2]-12, 8192, gchord.chan, gchord.vel); 
-      else /* [SS] 2016-01-03 */
-        save_note(g_num*len, g_denom, gchordnotes[gchordnotes_size], 8192, gchord.chan, gchord.vel); 
-      break;
-
-    case 'J':
-      if(gchordnotes_size >3)
-        save_note(g_num*len, g_denom, gchordnotes[3]-12, 8192, gchord.chan, gchord.vel); 
-      else /* [SS] 2016-01-03 */
-        save_note(g_num*len, g_denom, gchordnotes[gchordnotes_size], 8192, gchord.chan, gchord.vel); 
-      break;
-
-    /* [SS] 2021-12-10 */
-    case 'K':
-      if(gchordnotes_size >3)
-        save_note(g_num*len, g_denom, gchordnotes[4]-12, 8192, gchord.chan, gchord.vel); 
-      else /* [SS] 2016-01-03 */
-        save_note(g_num*len, g_denom, gchordnotes[gchordnotes_size], 8192, gchord.chan, gchord.vel); 
-      break;
-
-    case 'x':
-      if(!gchord_error) {
-         gchord_error++;
-         event_warning("no default gchord string for this meter");
-        }
-      break;
-
-     default:
-       printf("no such gchord code %c\n",action);
+    struct gchordstep *step;
+
+    if (!gchord_template_valid) compile_gchord_template();
+    step = &gchord_template[g_ptr];
+    len = step->len;
+    if (gchords && g_started) { /* [SS] 2021-06-27 2023-12-29*/
+      for (j=0; j<step->nnotes; j++)
+        save_note(g_num*len, g_denom, step->note[j].pitch, 8192,
+                  step->note[j].chan, step->note[j].vel);
+      if (step->action == 'x') {
+        if(!gchord_error) {
+           gchord_error++;
+           event_warning("no default gchord string for this meter");
+          }
+      } else if (strchr("zcfbghijkGHIJK", step->action) == NULL ||
+                 step->action == '\0') {
+        printf("no such gchord code %c\n",step->action);
       };
-
+    };
 
     g_ptr = g_ptr + 1; /* [SS] 2018-06-23 */
     addtoQ(g_num*len, g_denom, -1, g_ptr,0, 0);
-    if (g_ptr >= (int) strlen(gchord_seq)) g_ptr = 0; /* [SS] 2018-06-23 */
+    if (g_ptr >= gchord_seqlen) g_ptr = 0; /* [SS] 2018-06-23 */
     };
 };
 
 void dodrums(int i)
 /* generate drum notes */
 {
-  if (drum_ptr >= (int) strlen(drum_seq)) drum_ptr = 0; /* [SS] 2018-06-23 */
+  if (drum_ptr >= drum_seqlen) drum_ptr = 0; /* [SS] 2018-06-23 2026-10-18 */
   if (i == drum_ptr) {  /* [SS] 2018-06-23 */
     int len;
     char action;
@@ -2503,7 +2846,7 @@ void dodrums(int i)
     };
     drum_ptr = drum_ptr + 1;
     addtoQ(drum_num*len, drum_denom, -1, drum_ptr,0, 0);
-    if (drum_ptr >= (int) strlen(drum_seq)) drum_ptr = 0; /* [SS] 2018-06-23 */
+    if (drum_ptr >= drum_seqlen) drum_ptr = 0; /* [SS] 2018-06-23 2026-10-18 */
   };
 }
 
@@ -2711,6 +3054,7 @@ static void starttrack(int tracknum)
     gchord.chan = findchannel();
     channel_in_use[gchord.chan] = 1; /* [SS] 2015-03-27 2015-08-04 */
     if(verbose) printf("assigning channel %d to chordal accompaniment\n",gchord.chan);
+    gchord_template_valid = 0; /* [SS] 2026-10-18 */
     if (retuning) midi_re_tune (fun.chan); /* [SS] 2012-04-01 */
     if (retuning) midi_re_tune (gchord.chan); /* [SS] 2012-04-01 */
   };
@@ -2855,6 +3199,7 @@ long writetrack(int xtrack)
   bendnvals = 0;
   /* [SS] 2015-08-29 */
   for (i=0;i<MAXLAYERS;i++) controlnvals[i] = 0;
+  envelope_generation++;
 
 /* [SS] 2014-09-10 */
   if (karaoke) {
@@ -3298,7 +3643,7 @@ long writetrack(int xtrack)
                  (feature[j] != THICK_THIN) &&
                  (feature[j] != THIN_THICK) &&
                  (feature[j] != PLAY_ON_REP)) {
-            j = j + 1;
+            j = sectionstop[j + 1]; /* [SS] 2026-10-18 */
             if(feature[j] == VOICE) j = findvoice(j, trackvoice, xtrack);
           };
           barno = barno + 1;
@@ -3394,7 +3739,7 @@ long writetrack(int xtrack)
        graceflag = 0;
        break;
     case DYNAMIC:
-      dodeferred(atext[pitch[j]],noteson);
+      dodeferred(&deferred[pitch[j]],noteson); /* [SS] 2026-10-18 */
       break;
     case KEY:
       if(timekey) write_keysig(pitch[j], denom[j]);
@@ -1,6 +1,36 @@
 /* genmidi.h - part of abc2midi */
 /* function prototypes for functions in genmidi.c used elsewhere */
 
+/* [SS] 2026-10-18 codes for the %%MIDI command words. The command */
+/* word is looked up once with midi_command_code() and the handlers */
+/* in store.c and genmidi.c compare codes instead of strings.       */
+enum midicommand {MIDI_UNKNOWN, MIDI_C, MIDI_BARLINES, MIDI_BASSPROG,
+                  MIDI_BASSVOL, MIDI_BEAT, MIDI_BEATACCENTS,
+                  MIDI_BEATMOD, MIDI_BEATSTRING, MIDI_BENDSTRING,
+                  MIDI_BENDSTRINGEX, MIDI_BENDVELOCITY, MIDI_CHANNEL,
+                  MIDI_CHORDATTACK, MIDI_CHORDNAME, MIDI_CHORDPROG,
+                  MIDI_CHORDVOL, MIDI_CONTROL, MIDI_CONTROLCOMBO,
+                  MIDI_CONTROLSTRING, MIDI_DELTALOUDNESS, MIDI_DRONE,
+                  MIDI_DRONEOFF, MIDI_DRONEON, MIDI_DRUM, MIDI_DRUMBARS,
+                  MIDI_DRUMMAP, MIDI_DRUMOFF, MIDI_DRUMON, MIDI_EXPAND,
+                  MIDI_FERMATAFIXED, MIDI_FERMATAPROPORTIONAL,
+                  MIDI_GCHORD, MIDI_GCHORDBARS, MIDI_GCHORDOFF,
+                  MIDI_GCHORDON, MIDI_GRACE, MIDI_GRACEDIVIDER,
+                  MIDI_HARPMODE, MIDI_MAKECHORDCHANNELS,
+                  MIDI_NOBARLINES, MIDI_NOBEATACCENTS,
+                  MIDI_NOPORTAMENTO, MIDI_PITCHBEND,
+                  MIDI_PITCHBENDRANGE, MIDI_PORTAMENTO, MIDI_PROGRAM,
+                  MIDI_PROGRAMBASE, MIDI_PTSTRESS,
+                  MIDI_RANDOMCHORDATTACK, MIDI_RATIO, MIDI_RTRANSPOSE,
+                  MIDI_SNT, MIDI_STRESSMODEL, MIDI_TEMPERAMENTEQUAL,
+                  MIDI_TEMPERAMENTLINEAR, MIDI_TEMPERAMENTNORMAL,
+                  MIDI_TRANSPOSE, MIDI_TRIM, MIDI_TUNINGSYSTEM,
+                  MIDI_VOL, MIDI_VOLINC};
+
+/* [SS] 2015-07-24 number of %%MIDI controlstring layers which can */
+/* be combined with %%MIDI controlcombo (see also queues.c)         */
+#define MAXLAYERS 3
+
 #ifndef KANDR
 /* functions required by store.c */
 extern void reduce(int* a, int* b);
@@ -8,6 +38,11 @@ extern void set_meter(int a, int b);
 extern void set_gchords(char *s);
 extern void set_drums(char *s);
 extern void addunits(int a, int b);
+extern int midi_command_code(char *name);
+extern void compile_deferred(void);
+extern void free_deferred(void);
+extern void index_voices(void);
+extern void free_voice_index(void);
 /* required by queues.c */
 extern void midi_noteoff(long delta_time, int pitch, int chan);
 extern void progress_sequence(int i);
@@ -18,6 +53,11 @@ extern void set_meter();
 extern void set_gchords();
 extern void addunits();
 extern void set_drums();
+extern int midi_command_code();
+extern void compile_deferred();
+extern void free_deferred();
+extern void index_voices();
+extern void free_voice_index();
 /* required by queues.c */
 extern void midi_noteoff();
 extern void progress_sequence();
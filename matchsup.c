@@ -468,30 +468,14 @@ void event_error(char *s)
 /* generic error handler */
 {
 if (noerror) return;
-#ifdef NOFTELL
-  extern int nullpass;
-
-  if (nullpass != 1) {
-    printf("Error in line %d : %s\n", lineno, s);
-  };
-#else
   printf("Error in line %d : %s\n", lineno, s);
-#endif
 }
 
 void event_warning(char *s)
 /* generic warning handler - for flagging possible errors */
 {
 if (nowarn) return;
-#ifdef NOFTELL
-  extern int nullpass;
-
-  if (nullpass != 1) {
-    printf("Warning in line %d : %s\n", lineno, s);
-  };
-#else
   printf("Warning in line %d : %s\n", lineno, s);
-#endif
 }
 
 static int autoextend(int maxnotes)
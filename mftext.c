@@ -51,7 +51,9 @@ int main(int argc, char *argv[])
 
   initfuncs();
   Mf_getc = filegetc;
+  mf_loadfile(F); /* [SS] 2026-10-18 */
   midifile();
+  mf_freefile();
   fclose(F);
   exit(0);
 }
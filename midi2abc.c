@@ -132,6 +132,7 @@ int swallow_rests; /* flag - absorb short rests                 */
 int midiprint; /* flag - run midigram instead of midi2abc       */
 int stats = 0; /* flag - gather and print statistics            */
 int usesplits; /* flag - split measure into parts if needed     */
+int streaming; /* flag - decode and print tracks one at a time   */
 int restsize; /* smallest rest to absorb                        */
 /* [SS] 2017-01-01 */
 /*int no_triplets;  flag - suppress triplets or broken rhythm   */
@@ -188,6 +189,20 @@ struct listx {
   struct anote* note;
 };
 
+/* [SS] 2026-10-18 notes and their list links are not malloc'd one  */
+/* at a time. Each track fills its own block of NOTEBLOCK entries,   */
+/* so consecutive notes of a track sit next to each other in memory */
+/* and the list walks touch memory in order. The blocks of a track  */
+/* are chained from track[].block, so freetracknotes() releases all */
+/* the notes of a track in one step.                                 */
+#define NOTEBLOCK 512
+struct noteblock {
+  struct noteblock* next; /* arena chain */
+  int used;
+  struct listx x[NOTEBLOCK];
+  struct anote n[NOTEBLOCK];
+};
+
 /* linked list of text items (strings) */
 struct tlistx {
   struct tlistx* next;
@@ -210,10 +225,13 @@ struct atrack {
   int drumtrack;
   /* [SS] 2019-05-29 for debugging */
   int texts;            /* number of text links in track */
+  struct noteblock* block; /* block receiving new notes [SS] 2026-10-18 */
+  int released;          /* notes freed until the track is printed (-stream) */
 };
 
-/* can cope with up to 64 track MIDI files */
-struct atrack track[64];
+/* [SS] 2026-10-18 the track table grows with the MIDI file */
+struct atrack* track = NULL;
+int trackalloc = 0;
 int trackcount = 0;
 int maxbarcount = 0;
 /* maxbarcount  is used to return the numbers of bars created.*/
@@ -275,11 +293,14 @@ void fatal_error(char *s)
 }
 
 
+int reloading = 0; /* a -stream track is being decoded again */
+
 void event_error(char *s)
 /* problem encountered but OK to continue */
 {
   char msg[256];
 
+  if (reloading) return; /* already reported on the first reading */
   sprintf(msg, "Error: Time=%ld Track=%d %s\n", Mf_currtime, trackno, s);
   printf("%s",msg);
 }
@@ -373,31 +394,115 @@ void addtext_type0(char *s, int type, int chn)
 /* number to find the right note. While we are parsing the MIDI file */
 /* we maintain a list of all the notes that are currently on         */
 /* head and tail of list of notes still playing.                     */
-/* The following doubly linked list is used for this purpose         */
+/* [SS] 2026-10-18 there is one list per channel and pitch, so a     */
+/* note off goes straight to its list. A note off ends the earliest  */
+/* note still on with that pitch and channel.                        */
+
+#define PLAYINGKEYS 4096 /* 16 channels * 256 pitch values */
+struct dlistx* playinghead[PLAYINGKEYS];
+struct dlistx* playingtail[PLAYINGKEYS]; 
+int notesplaying; /* number of notes in all the lists */
+
+/* [SS] 2026-10-18 dlistx links are recycled through a free list */
+struct dlistx* freedlistx = NULL;
+
+struct dlistx* newdlistx()
+{
+  struct dlistx* d;
+
+  if (freedlistx != NULL) {
+    d = freedlistx;
+    freedlistx = d->next;
+  } else {
+    d = (struct dlistx*) checkmalloc(sizeof(struct dlistx));
+  };
+  return(d);
+}
+
+void freedlist(struct dlistx *d)
+{
+  d->next = freedlistx;
+  freedlistx = d;
+}
+
+struct listx* newnotelink(struct atrack *t)
+/* returns a list link with its note from the track's current block */
+{
+  struct noteblock* b;
+  struct listx* x;
+
+  b = t->block;
+  if (b == NULL || b->used == NOTEBLOCK) {
+    b = (struct noteblock*) checkmalloc(sizeof(struct noteblock));
+    b->used = 0;
+    b->next = t->block;
+    t->block = b;
+  };
+  x = &b->x[b->used];
+  x->note = &b->n[b->used];
+  b->used = b->used + 1;
+  return(x);
+}
+
+void freetracknotes(int j)
+/* releases every note of track j in one step */
+{
+  struct noteblock* b;
+
+  while (track[j].block != NULL) {
+    b = track[j].block->next;
+    free(track[j].block);
+    track[j].block = b;
+  };
+  track[j].head = NULL;
+  track[j].tail = NULL;
+}
 
-struct dlistx* playinghead;
-struct dlistx* playingtail; 
+void freenotes()
+{
+  int j;
+
+  for (j=0; j<trackalloc; j++) {
+    freetracknotes(j);
+  };
+}
+
+void growtracks(int n)
+/* makes sure track[0] to track[n-1] exist */
+{
+  int newalloc;
+
+  if (n <= trackalloc) return;
+  newalloc = (trackalloc == 0) ? 32 : 2*trackalloc;
+  while (newalloc < n) newalloc = 2*newalloc;
+  track = (struct atrack*) realloc(track, newalloc*sizeof(struct atrack));
+  if (track == NULL) {
+    fatal_error("Out of memory error - cannot realloc!");
+  };
+  memset(track + trackalloc, 0, (newalloc - trackalloc)*sizeof(struct atrack));
+  trackalloc = newalloc;
+}
 
 
 void noteplaying(struct anote *p)
 /* This function adds a new note to the playinghead list. */
 {
   struct dlistx* newx;
+  int key;
 
-  newx = (struct dlistx*) checkmalloc(sizeof(struct dlistx));
+  key = (p->chan & 15)*256 + (p->pitch & 255);
+  newx = newdlistx();
   newx->note = p;
   newx->next = NULL;
-  newx->last = playingtail;
-  if (playinghead == NULL) {
-    playinghead = newx;
-  };
-  if (playingtail == NULL) {
-    playingtail = newx;
+  newx->last = playingtail[key];
+  if (playingtail[key] == NULL) {
+    playinghead[key] = newx;
   } 
   else {
-    playingtail->next = newx;
-    playingtail = newx;
+    playingtail[key]->next = newx;
   };
+  playingtail[key] = newx;
+  notesplaying = notesplaying + 1;
 }
 
 
@@ -409,10 +514,9 @@ void addnote(int p, int ch, int v)
   struct anote* newnote;
 
   track[trackno].notes = track[trackno].notes + 1;
-  newx = (struct listx*) checkmalloc(sizeof(struct listx));
-  newnote = (struct anote*) checkmalloc(sizeof(struct anote));
+  newx = newnotelink(&track[trackno]);
+  newnote = newx->note;
   newx->next = NULL;
-  newx->note = newnote;
   if (track[trackno].head == NULL) {
     track[trackno].head = newx;
     track[trackno].tail = newx;
@@ -442,10 +546,9 @@ void addnote_type0(int p, int ch, int v)
   struct anote* newnote;
 
   track[ch].notes = track[ch].notes + 1;
-  newx = (struct listx*) checkmalloc(sizeof(struct listx));
-  newnote = (struct anote*) checkmalloc(sizeof(struct anote));
+  newx = newnotelink(&track[ch]);
+  newnote = newx->note;
   newx->next = NULL;
-  newx->note = newnote;
   if (track[ch].head == NULL) {
     track[ch].head = newx;
     track[ch].tail = newx;
@@ -473,20 +576,12 @@ void notestop(int p, int ch)
 /* used when parsing MIDI file */
 {
   struct dlistx* i;
-  int found;
+  int key;
   char msg[80];
 
-  i = playinghead;
-  found = 0;
-  while ((found == 0) && (i != NULL)) {
-    if ((i->note->pitch == p)&&(i->note->chan==ch)) {
-      found = 1;
-    } 
-    else {
-      i = i->next;
-    };
-  };
-  if (found == 0) {
+  key = (ch & 15)*256 + (p & 255);
+  i = playinghead[key];
+  if (i == NULL) {
     sprintf(msg, "Note terminated when not on - pitch %d", p);
     event_error(msg);
     return;
@@ -494,19 +589,15 @@ void notestop(int p, int ch)
   /* fill in tplay field */
   i->note->tplay = Mf_currtime - (i->note->tplay);
   /* remove note from list */
-  if (i->last == NULL) {
-    playinghead = i->next;
-  } 
-  else {
-    (i->last)->next = i->next;
-  };
+  playinghead[key] = i->next;
   if (i->next == NULL) {
-    playingtail = i->last;
+    playingtail[key] = NULL;
   } 
   else {
-    (i->next)->last = i->last;
+    (i->next)->last = NULL;
   };
-  free(i);
+  notesplaying = notesplaying - 1;
+  freedlist(i);
 }
 
 
@@ -533,10 +624,21 @@ void error(char *s)
 
 
 
+/* [SS] 2026-10-18 With -stream only the notes of the first track */
+/* with notes (maintrack) are kept while the file is read. The notes */
+/* of a later track are counted for findkey() and freed at the end   */
+/* of the track, then decoded again when the track is printed. A     */
+/* track sharing playing notes with its neighbours is kept, since    */
+/* decoding it alone would pair its note offs differently.           */
+int playingatstart; /* notes playing when the track started */
+int foundmain = 0;  /* a track with notes has been read */
+int releasedpitches[12]; /* pitch classes of the released notes */
+
 void txt_header(int xformat, int ntrks, int ldivision)
 {
     division = ldivision; 
     format = xformat;
+    growtracks(ntrks < 16 ? 17 : ntrks+1); /* [SS] 2026-10-18 */
     if (format != 0) {
     /*  fprintf(outhandle,"%% format %d file %d tracks\n", format, ntrks);*/
       if(summary>0) printf("This midi file has %d tracks\n\n",ntrks);
@@ -561,6 +663,8 @@ void txt_header(int xformat, int ntrks, int ldivision)
 
 void txt_trackstart()
 {
+  growtracks(trackno+2); /* [SS] 2026-10-18 */
+  playingatstart = notesplaying;
   laston = 0L;
   track[trackno].notes = 0;
   track[trackno].texts = 0; /* [SS] 2019-05-29 */
@@ -592,12 +696,31 @@ void txt_trackstart_type0()
 }
 
 
+
+void release_track(int j)
+{
+  struct listx* p;
+
+  for (p = track[j].head; p != NULL; p = p->next) {
+    releasedpitches[p->note->pitch % 12]++;
+  };
+  freetracknotes(j);
+  track[j].released = 1;
+}
+
 void txt_trackend()
 {
+  growtracks(trackno+2); /* also used by -midigram and -mftext */
   /* check for unfinished notes */
-  if (playinghead != NULL) {
+  if (notesplaying != 0) {
     printf("Error in MIDI file - notes still on at end of track!\n");
   };
+  if (streaming && format != 0 && track[trackno].notes > 0) {
+    if (foundmain && playingatstart == 0 && notesplaying == 0) {
+      release_track(trackno);
+    };
+    foundmain = 1;
+  };
   track[trackno].tracklen = Mf_currtime - track[trackno].tracklen;
   trackno = trackno + 1;
   trackcount = trackcount + 1;
@@ -1501,6 +1624,43 @@ void initfuncs()
 }
 
 
+/* [SS] 2026-10-18 decoding a released track again (-stream) */
+void txt_trackstart_reload()
+{
+  laston = 0L;
+  track[trackno].notes = 0;
+  track[trackno].head = NULL;
+  track[trackno].tail = NULL;
+  track[trackno].drumtrack = 0;
+}
+
+void initfuncs_reload()
+/* only the notes are wanted, the rest was kept on the first reading */
+{
+    Mf_header = &no_op3;
+    Mf_trackstart = &txt_trackstart_reload;
+    Mf_trackend = &no_op0;
+    Mf_noteon = &txt_noteon;
+    Mf_noteoff = &txt_noteoff;
+    Mf_pressure = &no_op3;
+    Mf_parameter = &no_op3;
+    Mf_pitchbend = &no_op3;
+    Mf_program = &no_op2;
+    Mf_chanpressure = &no_op3;
+    Mf_sysex = &no_op2_is;
+    Mf_metamisc = &no_op3_iis;
+    Mf_seqnum = &no_op1;
+    Mf_eot = &no_op0;
+    Mf_timesig = &no_op4;
+    Mf_smpte = &no_op5;
+    Mf_tempo = &no_op_l;
+    Mf_keysig = &no_op2;
+    Mf_seqspecific = &no_op2_is;
+    Mf_text = &no_op3_iis;
+    Mf_arbitrary = &no_op2_is;
+}
+
+
 /*  Stage 2 Quantize MIDI tracks. Get key signature, time signature...   */ 
 
 
@@ -1622,11 +1782,21 @@ int quantize(int trackno, int xunit)
 
 void guesslengths(int trackno)
 /* work out most appropriate value for a unit of musical time */
+/* [SS] 2026-10-18 The 100 trial values of xunit are scored in a    */
+/* single pass over the notes. The error sums are the ones quantize()*/
+/* returns, kept in one array entry per trial.                       */
 {
   int i;
   int trial[100];
+  int tryunit[100];
+  int quantum[100];
+  int spare[100];
+  int xnum;
+  int lastunit;
   float avlen, factor, tryx;
   long min;
+  struct listx* j;
+  long dtnext;
 
   min = track[trackno].tracklen;
   if (track[trackno].notes == 0) {
@@ -1635,13 +1805,47 @@ void guesslengths(int trackno)
   avlen = ((float)(min))/((float)(track[trackno].notes));
   tryx = avlen * (float) 0.75;
   factor = tryx/100;
+  lastunit = 0;
+  for (i=0; i<100; i++) {
+    tryunit[i] = (int) tryx;
+    if (tryunit[i] == 0) {
+      /* quantize() rejects a zero xunit */
+      trial[i] = 10000;
+    }
+    else {
+      trial[i] = 0;
+      lastunit = tryunit[i];
+    };
+    quantum[i] = (int) (2.*tryunit[i]/parts_per_unitlen);
+    spare[i] = 0;
+    tryx = tryx + factor;
+  };
+  j = track[trackno].head;
+  while (j != NULL) {
+    dtnext = j->note->dtnext;
+    for (i=0; i<100; i++) {
+      if (tryunit[i] == 0) continue;
+      xnum = (2*(dtnext + spare[i] + (quantum[i]/4)))/quantum[i];
+      spare[i] = spare[i] + dtnext - (xnum*tryunit[i]/parts_per_unitlen);
+      if (spare[i] > 0) {
+        trial[i] = trial[i] + spare[i];
+      } 
+      else {
+        trial[i] = trial[i] - spare[i];
+      };
+      spare[i] = (spare[i] * 96)/100;
+    };
+    j = j->next;
+  };
   for (i=0; i<100; i++) {
-    trial[i] = quantize(trackno, (int) tryx);
     if ((long) trial[i] < min) {
       min = (long) trial[i];
-      xunit = (int) tryx;
+      xunit = tryunit[i];
     };
-    tryx = tryx + factor;
+  };
+  /* leave the notes quantized by the last trial, as before */
+  if (lastunit != 0) {
+    quantize(trackno, lastunit);
   };
 xunit_set = 1;
 }
@@ -1719,7 +1923,7 @@ int findkey(int maintrack)
   /* analyse pitches */
   /* find key */
   for (j=0; j<12; j++) {
-    n[j] = 0;
+    n[j] = releasedpitches[j]; /* [SS] 2026-10-18 */
   };
   min = track[maintrack].tail->note->pitch;
   max = min;
@@ -1874,7 +2078,7 @@ void addtochord(struct anote *p)
 
   if (debug > 3) printf("addtochord %d\n",p->pitch);
 
-  newx = (struct dlistx*) checkmalloc(sizeof(struct dlistx));
+  newx = newdlistx();
   newx->note = p;
   newx->next = NULL;
   newx->last = NULL;
@@ -1929,7 +2133,7 @@ struct dlistx* removefromchord(struct dlistx *i)
     (i->next)->last = i->last;
   };
   newi = i->next;
-  free(i);
+  freedlist(i);
   checkchordlist();
   return(newi);
 }
@@ -2459,21 +2663,140 @@ void handletext(long t, struct tlistx **textplace, int trackno)
    The xnum (delay) to next note is updated.
 */
 
-int splitstart[10],splitend[10]; /* used in forming chords from notes*/
-int lastposnum[10]; /* posnum of previous note in linked list */
+/* [SS] 2026-10-18 The number of splits is no longer limited to 10.   */
+/* Each split remembers the region of its last note. To place a note  */
+/* we need the lowest numbered split that has finished before the     */
+/* note starts, or whose last note has exactly the same region. The   */
+/* first is found from a tree over the split numbers holding the      */
+/* earliest end time below each node, the second from a hash table of */
+/* the regions, so placing a note takes O(log splits) time.           */
+struct splitvoice {
+  int start, end;          /* region of the last note in the split */
+  int lastposnum;          /* posnum of previous note in split */
+  struct anote* prevnote;  /* previous note in split */
+  int samenext, sameprev;  /* splits in the same splithash chain */
+};
+
+#define SPLITHASH 1024
+struct splitvoice* splits = NULL;
+int splitsalloc = 0;
+int* splitends = NULL;   /* tree of earliest end times, leaves at splitleaves */
+int splitleaves = 0;
+int splithash[SPLITHASH];
 int endposnum; /* posnum at last note in linked list */
-struct anote* prevnote[10]; /*previous note in linked list */
-struct listx*  last_i[10];  /*note after finishing processing bar*/
-int existingsplits[10]; /* existing splits in active bar */
-struct dlistx* splitchordhead[10]; /* chordhead list for splitnum */
-struct dlistx* splitchordtail[10]; /* chordtail list for splitnum */
-int splitgap[10]; /* gap to next note at end of split measure */
+
+int splithashkey(int start, int end)
+{
+  return (int) (((unsigned) start*31u + (unsigned) end) & (SPLITHASH-1));
+}
+
+void grow_splits(int n)
+/* makes room for split number n */
+{
+  int k;
+
+  if (n >= splitsalloc) {
+    splitsalloc = (splitsalloc == 0) ? 16 : 2*splitsalloc;
+    while (n >= splitsalloc) splitsalloc = 2*splitsalloc;
+    splits = (struct splitvoice*) realloc(splits,
+                splitsalloc*sizeof(struct splitvoice));
+    if (splits == NULL) {
+      fatal_error("Out of memory error - cannot realloc!");
+    };
+  };
+  if (n >= splitleaves) {
+    /* the leaves of the old tree become the first half of the new one */
+    int oldleaves;
+    int* newends;
+
+    oldleaves = splitleaves;
+    splitleaves = (splitleaves == 0) ? 16 : 2*splitleaves;
+    while (n >= splitleaves) splitleaves = 2*splitleaves;
+    newends = (int*) checkmalloc(2*splitleaves*sizeof(int));
+    for (k=0; k<splitleaves; k++) {
+      newends[splitleaves+k] = (k < oldleaves) ? splitends[oldleaves+k] : INT_MAX;
+    };
+    for (k=splitleaves-1; k>0; k--) {
+      newends[k] = newends[2*k] < newends[2*k+1] ? newends[2*k] : newends[2*k+1];
+    };
+    if (splitends != NULL) free(splitends);
+    splitends = newends;
+  };
+}
+
+void set_split_region(int k, int start, int end)
+{
+  struct splitvoice* v;
+  int h;
+
+  v = &splits[k];
+  /* move split k to the chain of its new region */
+  if (v->sameprev >= 0) {
+    splits[v->sameprev].samenext = v->samenext;
+  }
+  else if (v->sameprev == -1) {
+    splithash[splithashkey(v->start, v->end)] = v->samenext;
+  };
+  if (v->samenext >= 0) splits[v->samenext].sameprev = v->sameprev;
+  v->start = start;
+  v->end = end;
+  h = splithashkey(start, end);
+  v->sameprev = -1;
+  v->samenext = splithash[h];
+  if (v->samenext >= 0) splits[v->samenext].sameprev = k;
+  splithash[h] = k;
+  /* update the earliest end times */
+  k = k + splitleaves;
+  splitends[k] = end;
+  for (k=k/2; k>0; k=k/2) {
+    splitends[k] = splitends[2*k] < splitends[2*k+1] ?
+                     splitends[2*k] : splitends[2*k+1];
+  };
+}
+
+int free_split(int posnum)
+/* lowest numbered split which has finished by posnum or -1 */
+{
+  int k;
+
+  if (splitleaves == 0 || splitends[1] > posnum) return -1;
+  k = 1;
+  while (k < splitleaves) {
+    if (splitends[2*k] <= posnum) k = 2*k;
+    else k = 2*k+1;
+  };
+  return k - splitleaves;
+}
+
+int same_split(int posnum, int playnum)
+/* lowest numbered split whose last note has the same region or -1 */
+{
+  int k, found;
+
+  found = -1;
+  k = splithash[splithashkey(posnum, posnum+playnum)];
+  while (k >= 0) {
+    if (splits[k].start == posnum && splits[k].end - splits[k].start == playnum
+        && (found < 0 || k < found)) found = k;
+    k = splits[k].samenext;
+  };
+  return found;
+}
+
+void new_split(int k)
+{
+  grow_splits(k);
+  splits[k].start = splits[k].end = splits[k].lastposnum = 0;
+  splits[k].prevnote = NULL;
+  splits[k].sameprev = -2; /* not in a chain yet */
+  splits[k].samenext = -1;
+}
 
 void label_split(struct anote *note, int activesplit)
 {
 /* The function assigns a split number (activesplit), to
-   a specific note, (*note). We also update splitstart
-   and splitend which specifies the region in time where
+   a specific note, (*note). We also update the region of
+   the split which specifies where in time
    the another note must occur if it forms a proper chord.
    After assigning a split number to the note we need to
    update note->xnum as this indicates the gap to the
@@ -2484,19 +2807,20 @@ void label_split(struct anote *note, int activesplit)
    is created. It would be nice if the voices kept the
    high and low notes (in pitch) separate.
 */
+     struct splitvoice* v;
+
      note->splitnum = activesplit;
-     splitstart[activesplit] = note->posnum;
-     splitend[activesplit] = splitstart[activesplit] + note->playnum;
-     if (prevnote[activesplit]) 
-         prevnote[activesplit]->xnum = note->posnum - lastposnum[activesplit];
-     lastposnum[activesplit] = note->posnum;
-     prevnote[activesplit] = note;
+     set_split_region(activesplit, note->posnum, note->posnum + note->playnum);
+     v = &splits[activesplit];
+     if (v->prevnote) 
+         v->prevnote->xnum = note->posnum - v->lastposnum;
+     v->lastposnum = note->posnum;
+     v->prevnote = note;
      /* in case this is the last activesplit note make sure it
         xnum points to end of track. Otherwise it will be changed
         when the next activesplit note is labeled.
      */
      note->xnum = endposnum - note->posnum;
-     existingsplits[activesplit]++;
 }
 
 
@@ -2515,77 +2839,48 @@ int label_split_voices (int trackno)
    given the same split number.
 */ 
 int activesplit,nsplits;
-int done;
+int k, same;
 struct listx* i;
-int k;
-int firstposnum = 0; /* [SDG] 2020-06-03 */
+struct anote* note;
 /* initializations */
 activesplit = 0;
 nsplits = 0;
 if (debug > 4) printf("label_split_voices:\n");
-for (k=0;k<10;k++) {
-       splitstart[k]=splitend[k]=lastposnum[k]=0;
-       prevnote[k] = NULL;
-       existingsplits[k] = 0;
-       splitgap[k]=0;
-       }
+for (k=0;k<SPLITHASH;k++) splithash[k] = -1;
+for (k=1;k<2*splitleaves;k++) splitends[k] = INT_MAX;
 i = track[trackno].head;
 if (track[trackno].tail == 0x0) {return 0;}
 endposnum =track[trackno].tail->note->posnum +
            track[trackno].tail->note->playnum;
 
-if (i != NULL) label_split(i->note, activesplit);
 /* now label all the notes in the track */
 while (i != NULL)
   {
-  done =0;
+  note = i->note;
   if (nsplits == 0) { /*no splits exist, create split number 0 */
      activesplit = 0;
      nsplits++;
-     i->note->splitnum = activesplit;
-     splitstart[activesplit] = i->note->posnum;
-     splitend[activesplit] = splitstart[activesplit] + i->note->playnum;
-     firstposnum = splitstart[activesplit];
-     } else {  /* do a compatibility check with the last split number */
-  if (  (   i->note->posnum == splitstart[activesplit] 
-         && i->note->playnum == (splitend[activesplit] - splitstart[activesplit]))
-      || i->note->posnum >= splitend[activesplit])
-     {
-     if (existingsplits[activesplit] == 0) {
-         last_i[activesplit] = i;
-         splitgap[activesplit] = i->note->posnum - firstposnum;
-         }
-     label_split(i->note, activesplit);
-     done = 1;
+     new_split(activesplit);
      }
-/* need to search for any other compatible split numbers  */
-  if (done == 0) for (activesplit=0;activesplit<nsplits;activesplit++) {
-      if (  (   i->note->posnum == splitstart[activesplit] 
-             && i->note->playnum == splitend[activesplit] - splitstart[activesplit])
-          || i->note->posnum >= splitend[activesplit])
-       {
-        if (existingsplits[activesplit] == 0) {
-           last_i[activesplit] = i;
-           splitgap[activesplit] = i->note->posnum - firstposnum;
-           }
-        label_split(i->note,activesplit);
-        done = 1;
-        break;
-        }
-      }
-     
-/* No compatible split number found. Create new split */
-   if (done == 0) {
-     if(nsplits < 10) {nsplits++; activesplit = nsplits-1;}  
-     if (existingsplits[activesplit] == 0) {
-         last_i[activesplit] = i;
-         splitgap[activesplit] = i->note->posnum - firstposnum;
-         }
-     label_split(i->note,activesplit);
-     }
-   } 
-if (debug>2)  printf("note %d links to %d  %d (%d %d)\n",i->note->pitch,activesplit,
-i->note->posnum,splitstart[activesplit],splitend[activesplit]);
+  /* do a compatibility check with the last split number */
+  else if (!( (   note->posnum == splits[activesplit].start 
+               && note->playnum == splits[activesplit].end - splits[activesplit].start)
+             || note->posnum >= splits[activesplit].end))
+     {
+     /* need to search for any other compatible split numbers  */
+     activesplit = free_split(note->posnum);
+     same = same_split(note->posnum, note->playnum);
+     if (same >= 0 && (activesplit < 0 || same < activesplit)) activesplit = same;
+     /* No compatible split number found. Create new split */
+     if (activesplit < 0) {
+       activesplit = nsplits;
+       nsplits++;
+       new_split(activesplit);
+       };
+     };
+  label_split(note, activesplit);
+if (debug>2)  printf("note %d links to %d  %d (%d %d)\n",note->pitch,activesplit,
+note->posnum,splits[activesplit].start,splits[activesplit].end);
 
   i = i->next;
   } /* end while loop */
@@ -2593,36 +2888,18 @@ return nsplits;
 }
 
 
-int nextsplitnum(int splitnum)
-  {
-  while (splitnum < 9) {
-      splitnum++;
-      if (existingsplits[splitnum]) return splitnum;
-      } 
-     return -1;
-}
-
-
-int count_splits()
-{
-int i,n;
-n = 0;
-for (i=0;i<10;i++)
-  if (existingsplits[i]) n++;
-return n;
-}
-
-
 /* [SS] 2019-06-26 */
-int firstgap[10];
+int* firstgap = NULL;
 
-void set_first_gaps (int trackno) {
+void set_first_gaps (int trackno, int nsplits) {
 struct listx* i;
 int j;
 int start;
 int splitnumber;
 start = track[trackno].startunits;
-for (j=0;j<10;j++) firstgap[j] = -1;
+if (firstgap != NULL) free(firstgap);
+firstgap = (int*) checkmalloc((nsplits+1)*sizeof(int));
+for (j=0;j<nsplits;j++) firstgap[j] = -1;
 i = track[trackno].head;
 while((i != NULL)) {
   splitnumber =  i->note->splitnum; 
@@ -2675,7 +2952,10 @@ void printtrack_split (int trackno, int splitnum, int anacrusis)
 
   textplace = track[trackno].texthead;
   textplace0 = track[0].texthead;
-  fprintf(outhandle,"V: split%d%c\n",trackno+1,'A'+splitnum);
+  if (splitnum < 26)
+    fprintf(outhandle,"V: split%d%c\n",trackno+1,'A'+splitnum);
+  else
+    fprintf(outhandle,"V: split%d_%d\n",trackno+1,splitnum+1);
   newline_flag = 1; /* [SS] 2019-06-14 */
 
   while((i != NULL)||(gap != 0)) {
@@ -2785,7 +3065,7 @@ void printtrack_split_voice(int trackno, int anacrusis)
   struct tlistx* textplace;
   nsplits = label_split_voices (trackno);
   /*printf("%d splits were detected\n",nsplits);*/
-  set_first_gaps (trackno);  /* [SS] 2019-06-26 */
+  set_first_gaps (trackno, nsplits);  /* [SS] 2019-06-26 */
   textplace = track[trackno].texthead;
   midline = 0;
   inkaraoke = 0;
@@ -3217,6 +3497,11 @@ int process_command_line_arguments(int argc, char *argv[])
   if (arg != -1) 
    usesplits = 2;
 
+  streaming = 0; /* [SS] 2026-10-18 */
+  arg = getarg("-stream",argc,argv);
+  if (arg != -1) 
+   streaming = 1;
+
   arg = getarg("-mftext",argc,argv);
   if (arg != -1) 
    {
@@ -3444,6 +3729,7 @@ int process_command_line_arguments(int argc, char *argv[])
     printf("         -nogr No note grouping. Space between all notes\n");
     printf("         -noly Suppress lyric output\n");
     printf("         -splitvoices  splits voices to avoid nonhomophonic chords\n");
+    printf("         -stream decode and print the tracks one at a time\n");
     printf("         -title <string> Pastes title following\n");
     printf("         -origin <string> Adds O: field containing string\n");
     printf("         -midigram   Prints midigram \n");
@@ -3467,6 +3753,38 @@ int process_command_line_arguments(int argc, char *argv[])
 
 
 
+/* [SS] 2026-10-18 */
+void reload_track(int j)
+/* decodes the notes of a track released by -stream before printing it */
+{
+  int k;
+  int savetrackno;
+
+  /* notes left playing belong to kept tracks and are not needed */
+  for (k=0; k<PLAYINGKEYS; k++) {
+    while (playinghead[k] != NULL) {
+      struct dlistx* d;
+
+      d = playinghead[k];
+      playinghead[k] = d->next;
+      freedlist(d);
+    };
+    playingtail[k] = NULL;
+  };
+  notesplaying = 0;
+  savetrackno = trackno;
+  trackno = j;
+  reloading = 1;
+  initfuncs_reload();
+  mfreadtrk(j+1);
+  reloading = 0;
+  trackno = savetrackno;
+  track[j].released = 0;
+  postprocess(j);
+  quantize(j, xunit);
+}
+
+
 void midi2abc (int arg, char *argv[])
 {
 int voiceno;
@@ -3479,13 +3797,19 @@ printf("calling midi2abc\n");
 
 /* initialization */
   trackno = 0;
+  growtracks(17); /* [SS] 2026-10-18 */
   track[trackno].texthead = NULL;
   track[trackno].texttail = NULL;
   initfuncs();
-  playinghead = NULL;
-  playingtail = NULL;
+  for (j=0; j<PLAYINGKEYS; j++) {
+    playinghead[j] = NULL;
+    playingtail[j] = NULL;
+  };
+  notesplaying = 0;
   karaoke = 0;
   Mf_getc = filegetc;
+  mf_loadfile(F); /* [SS] 2026-10-18 */
+  if (guessa) streaming = 0; /* guessana() needs every track */
 
 /* parse MIDI file */
   mfread();
@@ -3593,6 +3917,7 @@ if (trackcount == 1) {
     for (j=0; j<trackcount; j++) {
       freshline();
       if (track[j].notes > 0) {
+        if (track[j].released) reload_track(j); /* [SS] 2026-10-18 */
         if(debug > 0) printf("outputting track %d\n",j);
         fprintf(outhandle,"V:%d\n", voiceno);
 	if (track[j].drumtrack) fprintf(outhandle,"%%%%MIDI channel 10\n");
@@ -3605,6 +3930,7 @@ if (trackcount == 1) {
 
       if (usesplits==2) printtrack_split_voice(j, anacrusis);
       else printtrack(j,anacrusis);
+      if (streaming && j != maintrack) freetracknotes(j);
       }; /*track[j].notes > 0 */
     } /* for loop */
 
@@ -3640,19 +3966,12 @@ if (trackcount == 1) {
 
 
 /* free up data structures */
+  freenotes(); /* [SS] 2026-10-18 */
+  mf_freefile(); /* kept until now for reload_track() */
   for (j=0; j< trackcount; j++) {
-    struct listx* this;
-    struct listx* x;
     struct tlistx* tthis;
     struct tlistx* tx;
 
-    this = track[j].head;
-    while (this != NULL) {
-      free(this->note);
-      x = this->next ;
-      free(this);
-      this = x;
-    };
     tthis = track[j].texthead;
     while (tthis != NULL) {
       free(tthis->text);
@@ -3673,7 +3992,9 @@ init_chanbend();
 for (i=0;i<17;i++) {last_tick[i]=0;}
 /*F = efopen(argv[argc -1],"rb");*/
 Mf_getc = filegetc;
+mf_loadfile(F); /* [SS] 2026-10-18 */
 mfread();
+mf_freefile();
 verylasttick = 0;
 for (i=0;i<17;i++) {
   if(verylasttick < last_tick[i]) verylasttick = last_tick[i];
@@ -3689,7 +4010,9 @@ init_notechan();
 for (i=0;i<17;i++) {last_tick[i]=0;}
 /*F = efopen(argv[argc -1],"rb");*/
 Mf_getc = filegetc;
+mf_loadfile(F); /* [SS] 2026-10-18 */
 mfread();
+mf_freefile();
 /*printf("%d\n",last_tick);*/
 }
 
@@ -56,6 +56,7 @@
 #include "midicopy.h"
 #define NULLFUNC 0
 #define NULL 0
+#define MAXTRACKNUM 65535 /* the MThd track count is 16 bits [SS] 2026-10-18 */
 
 #ifndef PCCFIX
 #include <stdlib.h>
@@ -84,6 +85,7 @@ void append_to_string (int c);
 void winamp_compatibility_measure ();
 void writechanmsg_at_0 ();
 void copy_noteoff (int chan, int c1, int c2);
+void grow_track_flags (int n);
 static void write32bit(long);
 static void write16bit(int);
 
@@ -100,8 +102,10 @@ long Mf_currcopytime = 0L;	/* time of last copied event */
 char *trackdata = NULL;
 long trackdata_length, trackdata_size;
 /* char *trackstr[64];  [SS] 2017-10-20  2019-07-05*/
-char *trackstr[150]; /* [SS] 2023-11-07 */
-int trackstr_length[150]; /* [SS] 2017-10-20 2019-07-05* 2023-11-07*/
+/* [SS] 2026-10-18 trackstr grows with the number of tracks written */
+char **trackstr = NULL;
+int *trackstr_length = NULL; /* [SS] 2017-10-20 2019-07-05* 2023-11-07*/
+int trackstr_size = 0;
 int trkid = 0;
 int activetrack;
 int nochanmsg = 1;
@@ -144,16 +148,23 @@ void WriteVarLen (long);
 
 
 /* tocopy, tfocus, hastempo extended to handle 64 tracks [SS] 2019-07-05*/
+/* [SS] 2026-10-18 and now sized by grow_track_flags(). The track   */
+/* options grow them to the highest track they name; entries added  */
+/* later get the value the option gives to the tracks it does not   */
+/* list (tocopy_rest, tfocus_rest).                                 */
 int notechan[2048];		/* keeps track of running voices */
-int tocopy[64];			/* tracks to copy */
+int *tocopy = NULL;		/* tracks to copy */
 int ctocopy[16];		/* channels to copy */
 int dtocopy[82];                /* drums to copy  2019-12-22 */
-int tfocus[64];                 /* track focus    2017-11 27*/
+int *tfocus = NULL;             /* track focus    2017-11 27*/
 int cfocus[16];                 /* channel focus  2017-11-27*/
 int drmflag = 0;                /* flag indicating drums selected 2019-12-22 */
 int verbatim = 0;		/* flag for verbatim transfer 2019-06-29 */
 int haschannel[17];             /* for determining which channels are in use */
-int hastempo[64];		/* indicates whether tempo command in track */
+int *hastempo = NULL;		/* indicates whether tempo command in track */
+int track_flags_size = 0;
+int tocopy_rest = 1;            /* tocopy of the tracks after the first 32 */
+int tfocus_rest = 0;            /* tfocus of the tracks after the first 32 */
 
 FILE *F_in, *fp;
 int format, ntrks, division;
@@ -1287,8 +1298,6 @@ build_new_midi_file (int format, int ntracks, int division, FILE *fp)
 
   get_tempo_info_from_track_1 ();
 
-  if (ntracks > 149) {printf("too many tracks\n"); exit(1); }
-
   /* The rest of the file is a series of tracks */
   for (i = 0; i < ntracks; i++)
     {
@@ -1404,6 +1413,15 @@ mf_write_track_chunk (int which_track, FILE *fp)
   trklength = trackdata_length;
   /*ier = fwrite (trackdata, 1, trackdata_length, fp); */
   trkid++;
+  if (trkid >= trackstr_size) {
+    trackstr_size = (trackstr_size == 0) ? 64 : 2*trackstr_size;
+    trackstr = (char **) realloc(trackstr, trackstr_size*sizeof(char *));
+    trackstr_length = (int *) realloc(trackstr_length, trackstr_size*sizeof(int));
+    if (trackstr == NULL || trackstr_length == NULL) {
+      printf("out of memory for %d tracks\n", trkid);
+      exit(1);
+    }
+  }
   trackstr[trkid] = (char *) malloc(trklength+2);
   /* trackstr[trkid] = strcpy(trackstr[trkid],trackdata); */
   memcpy(trackstr[trkid],trackdata,trklength);
@@ -1761,6 +1779,31 @@ getarg (char *option, int argc, char *argv[])
 }
 
 
+void
+grow_track_flags (int n)
+/* makes room in tocopy, tfocus and hastempo for n tracks [SS] 2026-10-18 */
+{
+  int i, size;
+
+  if (n <= track_flags_size)
+    return;
+  size = n;
+  tocopy = (int *) realloc (tocopy, size * sizeof (int));
+  tfocus = (int *) realloc (tfocus, size * sizeof (int));
+  hastempo = (int *) realloc (hastempo, size * sizeof (int));
+  if (tocopy == NULL || tfocus == NULL || hastempo == NULL)
+    {
+      printf ("out of memory for %d tracks\n", n);
+      exit (1);
+    }
+  for (i = track_flags_size; i < size; i++)
+    {
+      tocopy[i] = tocopy_rest;
+      tfocus[i] = tfocus_rest;
+      hastempo[i] = 0;
+    }
+  track_flags_size = size;
+}
 
 
 
@@ -1782,6 +1825,7 @@ main (int argc, char *argv[])
   int beats_per_minute = 0;	/* [SS] 2013-09-04 */
   long trkhdr; /* [SS] 2017-10-20 */
 
+  grow_track_flags (32); /* [SS] 2026-10-18 */
   for (i = 0; i < 32; i++)
     tocopy[i] = 1;
   for (i = 0; i < 16; i++)
@@ -1863,9 +1907,13 @@ main (int argc, char *argv[])
       /* printf("%d tracks specified\n", mtrks); */
       for (i = 0; i < 32; i++)
 	tocopy[i] = 0;
+      tocopy_rest = 0;
       for (i = 0; i < mtrks; i++)
-	if (trk[i] < 32 && trk[i] >= 0)
-	  tocopy[trk[i] - 1] = 1;
+	if (trk[i] > 0 && trk[i] <= MAXTRACKNUM) /* [SS] 2026-10-18 */
+	  {
+	    grow_track_flags (trk[i]);
+	    tocopy[trk[i] - 1] = 1;
+	  }
     }
 
   arg = getarg ("-xtrks", argc, argv); /* [SS] 2013-10-27 */
@@ -1879,9 +1927,13 @@ main (int argc, char *argv[])
       /* printf("%d tracks specified\n", mtrks); */
       for (i = 0; i < 32; i++)
 	tocopy[i] = 1;
+      tocopy_rest = 1;
       for (i = 0; i < xtrks; i++)
-	if (trk[i] < 32 && trk[i] > 0)
-	  tocopy[trk[i] - 1] = 0;
+	if (trk[i] > 0 && trk[i] <= MAXTRACKNUM) /* [SS] 2026-10-18 */
+	  {
+	    grow_track_flags (trk[i]);
+	    tocopy[trk[i] - 1] = 0;
+	  }
     }
 
   arg = getarg("-xchns",argc,argv); /* [SS] 2017-12-06 */
@@ -2049,9 +2101,12 @@ main (int argc, char *argv[])
       /* printf("%d tracks specified\n", mtrks); */
       for (i = 0; i < 32; i++)
 	tfocus[i] = 1; /* attenuation flag */
+      tfocus_rest = 1;
       for (i = 0; i < mtrks; i++) {
-	if (trk[i] < 32 && trk[i] >= 0)
+	if (trk[i] > 0 && trk[i] <= MAXTRACKNUM) { /* [SS] 2026-10-18 */
+          grow_track_flags (trk[i]);
           tfocus[trk[i]-1] = 0; /* track numbers start from 1*/
+          }
         }
       }
     }
@@ -2162,6 +2217,7 @@ main (int argc, char *argv[])
 
 
   readheader ();
+  grow_track_flags (ntrks); /* [SS] 2026-10-18 */
 
   temposize = 0;               /* [SS] 2019-06-29 */
   tempo_array[temposize].tempo = current_tempo;
@@ -56,6 +56,10 @@
  * introduced some support for some universal system exclusive
  * messages (in particular single note tuning change).
  * reference http://www.midi.org/about-midi/tuning.shtml
+ *
+ * 18 Oct 2026
+ * track chunks are assembled in memory and written in one piece,
+ * so the NOFTELL version of mf_write_track_chunk is no longer needed.
  */
 #include "midifile.h"
 #define NULLFUNC 0
@@ -107,6 +111,16 @@ long Mf_currtime = 0L;    /* current time in delta-time units */
 long Mf_toberead = 0L;
 long Mf_bytesread = 0L;
 
+/* [SS] 2026-10-18 When mf_loadfile() has been called, the MIDI file */
+/* is decoded from memory instead of through Mf_getc one byte at a   */
+/* time. Mf_memp is the read position and Mf_memend the end of data. */
+static unsigned char *Mf_mem = NULL;
+static unsigned char *Mf_memp = NULL;
+static unsigned char *Mf_memend = NULL;
+/* [SS] 2026-10-18 track chunks found by mf_tracktable() */
+static struct mftrack *Mf_tracktable = NULL;
+static int Mf_ntracktable = 0;
+
 long Mf_numbyteswritten = 0L; /* linking with store.c */
 
 static long readvarinum();
@@ -126,6 +140,7 @@ static void sysex();
 static void chanmessage(int, int, int);
 static void msginit();
 static void msgadd(int);
+static void msgaddbytes(long);
 static void biggermsg();
 static void mf_write_track_chunk(int, FILE *);
 static void mf_write_header_chunk(int, int, int);
@@ -134,6 +149,7 @@ static void write32bit(long);
 static void write16bit(int);
 static int msgleng();
 static int eputc(char c);
+static void free_trackbuffer();
 /* end of block */
 
 
@@ -164,7 +180,20 @@ void mfreadtrk(int itrack)     /* The only non-static function in this file. */
   if ( Mf_getc == NULLFUNC )
     mferror("mfprocess() called without setting Mf_getc");
 
+  /* [SS] 2026-10-18 a file in memory can be read again from the start */
+  if (Mf_mem != NULL) {
+    Mf_memp = Mf_mem;
+    Mf_bytesread = 0L;
+  }
   readheader();
+  /* [SS] 2026-10-18 go straight to the track if the file is in memory */
+  if (Mf_mem != NULL && itrack >= 1 && itrack <= ntrks &&
+      mf_tracktable(NULL, NULL, NULL) >= itrack && mf_tracksregular(itrack)) {
+    Mf_memp = Mf_mem + Mf_tracktable[itrack-1].offset - 8;
+    Mf_bytesread = Mf_memp - Mf_mem;
+    (void) readtrack();
+    return;
+  }
   track =1;
   ok = 1;
   for (track=1;track<=ntrks && ok == 1;track++)
@@ -183,6 +212,56 @@ void midifile()
     mfread();
 }
 
+/* [SS] 2026-10-18 */
+long mf_loadfile(FILE *f)
+/* Reads the rest of f into memory. mfread() and mfreadtrk() then */
+/* decode the MIDI file from memory and Mf_getc is not called.    */
+/* Returns the number of bytes read.                              */
+{
+  long size, n;
+  unsigned char *p;
+
+  mf_freefile();
+  size = 65536L;
+  Mf_mem = (unsigned char *) malloc(size);
+  if (Mf_mem == NULL)
+    mferror("out of memory for MIDI file");
+  n = 0L;
+  for (;;) {
+    n += (long) fread(Mf_mem + n, 1, size - n, f);
+    if (n < size) break;
+    size = 2L * size;
+    p = (unsigned char *) realloc(Mf_mem, size);
+    if (p == NULL)
+      mferror("out of memory for MIDI file");
+    Mf_mem = p;
+  }
+  Mf_memp = Mf_mem;
+  Mf_memend = Mf_mem + n;
+  return n;
+}
+
+void mf_freefile()
+/* releases the memory allocated by mf_loadfile() */
+{
+  if (Mf_mem != NULL)
+    free(Mf_mem);
+  Mf_mem = NULL;
+  Mf_memp = NULL;
+  Mf_memend = NULL;
+}
+
+static int
+mfgetc()     /* next byte of the MIDI file or EOF */
+{
+  if (Mf_mem != NULL) {
+    if (Mf_memp < Mf_memend)
+      return *Mf_memp++;
+    return EOF;
+  }
+  return (*Mf_getc)();
+}
+
 static int
 readmt(char *s)    /* read through the "MThd" or "MTrk" header string */
 {
@@ -190,7 +269,7 @@ readmt(char *s)    /* read through the "MThd" or "MTrk" header string */
   char *p = s;
   int c;
 
-  while ( n++<4 && (c=(*Mf_getc)()) != EOF ) {
+  while ( n++<4 && (c=mfgetc()) != EOF ) {
     Mf_bytesread++; /* [SS] 2023-02-08 */
     if ( c != *p++ ) {
       char buff[32];
@@ -205,7 +284,7 @@ readmt(char *s)    /* read through the "MThd" or "MTrk" header string */
 static int
 egetc()      /* read a single character and abort on EOF */
 {
-  int c = (*Mf_getc)();
+  int c = mfgetc();
 
   if ( c == EOF )
     mferror("premature EOF");
@@ -243,6 +322,12 @@ if ( readmt("MTrk") == EOF )
     return(0);
 Mf_toberead = read32bit();
 byte = 0;
+/* [SS] 2026-10-18 skip the track in one step when it is in memory */
+if (Mf_mem != NULL && Mf_toberead > 0 && Mf_toberead <= Mf_memend - Mf_memp) {
+  Mf_memp += Mf_toberead;
+  Mf_bytesread += Mf_toberead;
+  Mf_toberead = 0;
+  }
 while (Mf_toberead && byte != EOF) byte = egetc();
 if (byte == EOF) {mferror("premature EOF\n"); return(0);}
 return(1);
@@ -335,6 +420,7 @@ readtrack()     /* read a track chunk */
       lookfor = Mf_toberead - varinum;
       msginit();
 
+      msgaddbytes(Mf_toberead - lookfor); /* [SS] 2026-10-18 */
       while ( Mf_toberead > lookfor )
         msgadd(egetc());
 
@@ -514,6 +600,27 @@ readvarinum()
 {
   long value;
   int c;
+  unsigned char *p;
+
+  /* [SS] 2026-10-18 decode directly from memory */
+  if (Mf_mem != NULL) {
+    p = Mf_memp;
+    value = 0L;
+    do {
+      if (p >= Mf_memend) {
+        Mf_toberead -= p - Mf_memp;
+        Mf_bytesread += p - Mf_memp;
+        Mf_memp = p;
+        mferror("premature EOF");
+      }
+      c = *p++;
+      value = (value << 7) + (c & 0x7f);
+    } while (c & 0x80);
+    Mf_toberead -= p - Mf_memp;
+    Mf_bytesread += p - Mf_memp;
+    Mf_memp = p;
+    return (value);
+  }
 
   c = egetc();
   value = c;
@@ -566,6 +673,192 @@ read16bit()
   return to16bit(c1,c2);
 }
 
+/* [SS] 2026-10-18 Pull interface to a MIDI file loaded with
+ * mf_loadfile(). mf_tracktable() finds the MTrk chunks, any of which
+ * can then be opened with mf_opentrack(). Each call to mf_nextevent()
+ * decodes the next event of the track. Event data is not copied;
+ * mfevent.data points into the loaded file. No Mf_ callbacks are
+ * called and the cursors hold all the state, so several tracks may
+ * be read at once, e.g. to merge them by time.
+ */
+
+static long
+memvarinum(unsigned char **pp, unsigned char *end)
+/* decodes a variable length number at *pp; -1 if it runs past end */
+{
+  unsigned char *p = *pp;
+  long value = 0L;
+  int c;
+
+  do {
+    if (p >= end)
+      return -1L;
+    c = *p++;
+    value = (value << 7) + (c & 0x7f);
+  } while (c & 0x80);
+  *pp = p;
+  return value;
+}
+
+static long
+mem32bit(unsigned char *p)
+{
+  return to32bit(p[0],p[1],p[2],p[3]);
+}
+
+int mf_tracktable(int *format, int *ntrks, int *division)
+/* Builds the table of track chunks of the file loaded by        */
+/* mf_loadfile(). Chunks which are not MTrk are passed over and  */
+/* counted in mftrack.skipped. A track running past the end of   */
+/* the file is cut short by mf_opentrack().                      */
+/* Returns the number of tracks or -1 if there is no valid MThd. */
+{
+  unsigned char *p, *end;
+  long length, skipped;
+  int size;
+
+  if (Mf_tracktable != NULL)
+    free(Mf_tracktable);
+  Mf_tracktable = NULL;
+  Mf_ntracktable = 0;
+  if (Mf_mem == NULL || Mf_memend - Mf_mem < 14 || mem32bit(Mf_mem) != MThd)
+    return -1;
+  length = mem32bit(Mf_mem + 4);
+  if (format != NULL)
+    *format = to16bit(Mf_mem[8], Mf_mem[9]);
+  if (ntrks != NULL)
+    *ntrks = to16bit(Mf_mem[10], Mf_mem[11]);
+  if (division != NULL)
+    *division = to16bit(Mf_mem[12], Mf_mem[13]);
+  end = Mf_memend;
+  if (length > end - Mf_mem - 8)
+    return -1;
+  if (length < 6)
+    length = 6;
+  p = Mf_mem + 8 + length;
+  size = 0;
+  skipped = 0L;
+  while (end - p >= 8) {
+    length = mem32bit(p + 4);
+    if (length < 0)
+      length = end - p - 8;
+    if (mem32bit(p) == MTrk) {
+      if (Mf_ntracktable >= size) {
+        size = (size == 0) ? 16 : 2*size;
+        Mf_tracktable = (struct mftrack *)
+          realloc(Mf_tracktable, size*sizeof(struct mftrack));
+        if (Mf_tracktable == NULL)
+          mferror("out of memory for track table");
+      }
+      Mf_tracktable[Mf_ntracktable].offset = (p + 8) - Mf_mem;
+      Mf_tracktable[Mf_ntracktable].length = length;
+      Mf_tracktable[Mf_ntracktable].skipped = skipped;
+      Mf_ntracktable++;
+      skipped = 0L;
+    } else {
+      skipped = skipped + 8 + length;
+    }
+    if (length > end - p - 8)
+      break;
+    p = p + 8 + length;
+  }
+  return Mf_ntracktable;
+}
+
+int mf_tracksregular(int n)
+/* 1 if the first n tracks follow the header and one another with no */
+/* other chunks in between, as mfread() expects.                     */
+{
+  int i;
+
+  for (i = 0; i < n && i < Mf_ntracktable; i++) {
+    if (Mf_tracktable[i].skipped != 0L)
+      return 0;
+    if (Mf_tracktable[i].offset + Mf_tracktable[i].length > Mf_memend - Mf_mem)
+      return 0;
+  }
+  return (n <= Mf_ntracktable);
+}
+
+int mf_trackinfo(int track, struct mftrack *info)
+/* copies the table entry of a track (numbered from 0) */
+{
+  if (track < 0 || track >= Mf_ntracktable)
+    return 0;
+  *info = Mf_tracktable[track];
+  return 1;
+}
+
+int mf_opentrack(struct mfcursor *cur, int track)
+/* positions cur at the first event of a track (numbered from 0) */
+{
+  if (Mf_mem == NULL || track < 0 || track >= Mf_ntracktable)
+    return 0;
+  cur->p = Mf_mem + Mf_tracktable[track].offset;
+  cur->end = cur->p + Mf_tracktable[track].length;
+  if (cur->end > Mf_memend)
+    cur->end = Mf_memend;
+  cur->time = 0L;
+  cur->status = 0;
+  cur->track = track;
+  return 1;
+}
+
+int mf_nextevent(struct mfcursor *cur, struct mfevent *ev)
+/* Decodes the next event of the track into ev. Running status is   */
+/* resolved, so ev->status always holds the status byte (0xff for a */
+/* meta event, whose type is in ev->type). ev->data points to the   */
+/* data bytes of a channel message or to the body of a meta or      */
+/* system exclusive event. Returns 1 for an event, 0 at the end of  */
+/* the track and -1 if the track is corrupt.                        */
+{
+  static int chantype[] = {
+    0, 0, 0, 0, 0, 0, 0, 0,    /* 0x00 through 0x70 */
+    2, 2, 2, 2, 1, 1, 2, 0    /* 0x80 through 0xf0 */
+  };
+  unsigned char *p = cur->p;
+  long delta, length;
+  int c;
+
+  if (p >= cur->end)
+    return 0;
+  delta = memvarinum(&p, cur->end);
+  if (delta < 0 || p >= cur->end)
+    return -1;
+  c = *p;
+  if ((c & 0x80) == 0) {   /* running status */
+    if (cur->status == 0)
+      return -1;
+    c = cur->status;
+  } else {
+    p++;
+  }
+  ev->type = 0;
+  if (chantype[(c >> 4) & 0xf]) {
+    cur->status = c;
+    length = chantype[(c >> 4) & 0xf];
+  } else if (c == 0xff) {
+    if (p >= cur->end)
+      return -1;
+    ev->type = *p++;
+    length = memvarinum(&p, cur->end);
+  } else if (c == 0xf0 || c == 0xf7) {
+    length = memvarinum(&p, cur->end);
+  } else {
+    return -1;
+  }
+  if (length < 0 || length > cur->end - p)
+    return -1;
+  cur->time += delta;
+  ev->delta = delta;
+  ev->time = cur->time;
+  ev->status = c;
+  ev->data = p;
+  ev->length = length;
+  cur->p = p + length;
+  return 1;
+}
+
 /* static */
 void mferror(char *s)
 {
@@ -614,6 +907,24 @@ msgadd(int c)
   Msgbuff[Msgindex++] = c;
 }
 
+/* [SS] 2026-10-18 */
+static void
+msgaddbytes(long n)
+/* adds the next n bytes of a MIDI file held in memory to the message */
+/* in one copy. Otherwise, or if the file ends early, nothing is done */
+/* and the caller adds the bytes one at a time with msgadd().         */
+{
+  if ( Mf_mem == NULL || n <= 0 || n > Mf_memend - Mf_memp )
+    return;
+  while ( Msgindex + n > Msgsize )
+    biggermsg();
+  memcpy(Msgbuff + Msgindex, Mf_memp, n);
+  Msgindex += n;
+  Mf_memp += n;
+  Mf_toberead -= n;
+  Mf_bytesread += n;
+}
+
 static void
 biggermsg()
 {
@@ -669,7 +980,9 @@ biggermsg()
  *             Files 1.0 spec for more details.
  * fp          This should be the open file pointer to the file you
  *             want to write.  It will have be a global in order
- *             to work with Mf_putc.  
+ *             to work with Mf_putc. Track chunks are written to it
+ *             directly with fwrite; if it is NULL they go through
+ *             Mf_putc as well.
  */ 
 void 
 mfwrite(int format, int ntracks, int division, FILE *fp) 
@@ -694,15 +1007,12 @@ mfwrite(int format, int ntracks, int division, FILE *fp)
     /* The rest of the file is a series of tracks */
     for(i = 0; i < ntracks; i++)
         mf_write_track_chunk(i,fp);
-}
 
-#ifdef NOFTELL
-int nullpass = 0;
-#endif
+    free_trackbuffer(); /* [SS] 2026-10-18 */
+}
 
 int nullputc(char c)
 /* dummy putc for abc checking option */
-/* also used for FTELL work-around */
 {
   int t;
 
@@ -710,74 +1020,63 @@ int nullputc(char c)
   return (t);
 }                         
 
-static void 
-mf_write_track_chunk(int which_track, FILE *fp)
+/* [SS] 2026-10-18 holds the track chunk being written by */
+/* mf_write_track_chunk, starting with its 8 byte header   */
+static char *trackbuffer = NULL;
+static long trackbuffersize = 0L;
+static long trackbufferlen = 0L;
+
+static void free_trackbuffer()
+/* releases trackbuffer once the last track has been written */
 {
-  long trkhdr,trklength;
-  long offset, place_marker;
-  long endspace = 0; /* [SDG] 2020-06-02 */
+  free(trackbuffer);
+  trackbuffer = NULL;
+  trackbuffersize = 0L;
+  trackbufferlen = 0L;
+}
 
-/* There is an alternate version of this code selected by NOFTELL
-   which doesn't require use of file seek */
-  
-#ifdef NOFTELL
-  int (*tempfunc)() = NULLFUNC;
-  extern int myputc(char c);
+static int trackputc(char c)
+/* Mf_putc while a track is being generated */
+{
+  char *p;
 
-  trkhdr = MTrk;
-  trklength = 0;
-  tempfunc = Mf_putc;
-  Mf_putc = nullputc;
-  Mf_numbyteswritten = 0L; /* the header's length doesn't count */
-  /* dummy write track */
-  nullpass = 1;
-  if( Mf_writetrack )
-  {
-    endspace = (*Mf_writetrack)(which_track);
-  }
-  WriteVarLen(endspace);
-  /* mf_write End of track meta event */
-  /* eputc(0); */
-  eputc(meta_event);
-  eputc(end_of_track);
-  eputc(0);
-  trklength = Mf_numbyteswritten;
-  /* now actually write track */
-  Mf_putc = tempfunc;
-  nullpass = 0;
-  write32bit(trkhdr);
-  write32bit(trklength);
-  Mf_numbyteswritten = 0L; /* the header's length doesn't count */
-  /* now output the data */
-  if( Mf_writetrack )
+  if (trackbufferlen >= trackbuffersize)
   {
-    endspace = (*Mf_writetrack)(which_track);
-  }
-  WriteVarLen(endspace);
-  eputc(meta_event);
-  eputc(end_of_track);
-  eputc(0);
-  if (trklength != Mf_numbyteswritten) {
-    mferror("NOFTELL workaround failed to predict tracklength");
+    if (trackbuffersize == 0L)
+      trackbuffersize = 16384L;
+    else
+      trackbuffersize = 2L * trackbuffersize;
+    p = (char *) realloc(trackbuffer, trackbuffersize);
+    if (p == NULL)
+    {
+      mferror("out of memory for track buffer");
+      return(EOF);
+    }
+    trackbuffer = p;
   }
+  trackbuffer[trackbufferlen++] = c;
+  return(((int) c) & 0xFF);
+}
 
-#else  
-  /* this is the original code */
-  trkhdr = MTrk;
-  trklength = 0;
-
-  /* Remember where the length was written, because we don't
-     know how long it will be until we've finished writing */
-  offset = ftell(fp); 
-
-#ifdef DEBUG
-        printf("offset = %d\n",(int) offset);
-#endif
-
-  /* Write the track chunk header */
-  write32bit(trkhdr);
-  write32bit(trklength);
+static void 
+mf_write_track_chunk(int which_track, FILE *fp)
+/* [SS] 2026-10-18 The track is generated into trackbuffer after  */
+/* room for the chunk header. Once the track is complete, its     */
+/* length is filled into the header and the whole chunk is written */
+/* with a single fwrite, so the output need not be seekable and    */
+/* may be a pipe. If fp is NULL, the chunk is passed to Mf_putc.   */
+{
+  long trkhdr,trklength;
+  long endspace = 0; /* [SDG] 2020-06-02 */
+  int (*fileputc)(char c);
+  long i;
 
+  trkhdr = MTrk;
+  fileputc = Mf_putc;
+  Mf_putc = trackputc;
+  trackbufferlen = 0L;
+  for (i = 0L; i < 8L; i++)
+    trackputc(0);
   Mf_numbyteswritten = 0L; /* the header's length doesn't count */
 
   if( Mf_writetrack )
@@ -792,32 +1091,27 @@ mf_write_track_chunk(int which_track, FILE *fp)
   eputc(end_of_track);
 
    eputc(0);
-   
-  /* It's impossible to know how long the track chunk will be beforehand,
-           so the position of the track length data is kept so that it can
-           be written after the chunk has been generated */
-  place_marker = ftell(fp);
-  
-  /* This method turned out not to be portable because the
-           parameter returned from ftell is not guaranteed to be
-           in bytes on every machine */
-   /* track.length = place_marker - offset - (long) sizeof(track); */
-
-#ifdef DEBUG
-printf("length = %d\n",(int) trklength);
-#endif
-
-   if(fseek(fp,offset,0) < 0)
-      mferror("error seeking during final stage of write");
 
+  Mf_putc = fileputc;
   trklength = Mf_numbyteswritten;
-
-  /* Re-mf_write the track chunk header with right length */
-  write32bit(trkhdr);
-  write32bit(trklength);
-
-  fseek(fp,place_marker,0);
-#endif
+  for (i = 0L; i < 4L; i++)
+  {
+    trackbuffer[i] = (char) ((trkhdr >> (24 - 8*i)) & 0xff);
+    trackbuffer[i+4] = (char) ((trklength >> (24 - 8*i)) & 0xff);
+  }
+  if (fp != NULL)
+  {
+    if ((long) fwrite(trackbuffer, 1, trackbufferlen, fp) != trackbufferlen)
+      mferror("error writing");
+  }
+  else
+  {
+    for (i = 0L; i < trackbufferlen; i++)
+    {
+      if ((*Mf_putc)(trackbuffer[i]) == EOF)
+        mferror("error writing");
+    }
+  }
 } /* End gen_track_chunk() */
 
 
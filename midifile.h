@@ -34,6 +34,39 @@ float mf_ticks2sec(long ticks, int division, long tempo);
 long mf_sec2ticks(float secs, int division, long tempo);
 void mfwrite(int format, int ntracks, int division, FILE *fp);
 void mfread();
+void mfreadtrk(int itrack);
+long mf_loadfile(FILE *f);
+void mf_freefile();
+
+/* [SS] 2026-10-18 pull interface, see mf_nextevent() in midifile.c */
+struct mftrack {
+  long offset;   /* of the track data, after the MTrk header */
+  long length;   /* from the header, may run past the end of file */
+  long skipped;  /* bytes of other chunks before this track */
+};
+
+struct mfcursor {
+  unsigned char *p;     /* next event */
+  unsigned char *end;   /* end of the track */
+  long time;            /* absolute time of the last event */
+  int status;           /* running status */
+  int track;
+};
+
+struct mfevent {
+  long delta;           /* ticks since the previous event */
+  long time;            /* absolute time in ticks */
+  int status;           /* status byte, 0xff for meta events */
+  int type;             /* type of a meta event */
+  long length;          /* number of bytes at data */
+  unsigned char *data;  /* points into the loaded file */
+};
+
+int mf_tracktable(int *format, int *ntrks, int *division);
+int mf_tracksregular(int n);
+int mf_trackinfo(int track, struct mftrack *info);
+int mf_opentrack(struct mfcursor *cur, int track);
+int mf_nextevent(struct mfcursor *cur, struct mfevent *ev);
 int mf_write_meta_event(long delta_time, int type, char *data, int size);
 int mf_write_midi_event (long delta_time, int type, int chan, char *data, int size);
 void mf_write_tempo(long);
@@ -145,9 +145,11 @@ int noOutput = 0;
 /* can cope with up to 64 track MIDI files */
 int trackcount = 0;
 
-int notechan[2048],notechanvol[2048]; /*for linking on and off midi
-					channel commands            */
-int lastTick[2048]; /* for getting last pulse number for chan (0-15) and pitch (0-127) in MIDI file */
+/* [SS] 2026-10-18 keyed like the playing lists of midi2abc: 16 channels */
+/* of 256 pitch values, so a corrupt pitch byte stays inside the array. */
+#define NOTEKEYS 4096
+#define notekey(chan,pitch) (((chan) & 15)*256 + ((pitch) & 255))
+int lastTick[NOTEKEYS]; /* for getting last pulse number for chan (0-15) and pitch (0-127) in MIDI file */
 int last_on_tick[17]; /* for detecting chords [SS] 2019-08-02 */
 int channel_active[17]; /* for dealing with chords [SS] 2023-08-30 */
 int channel_used_in_track[17]; /* for dealing with quietTime [SS] 2023-09-06 */
@@ -395,20 +397,6 @@ void stats_error(char *s)
  
 
 
-/* In order to associate a channel note off message with its
- * corresponding note on message, we maintain the information
- * the notechan array. When a midi pitch (0-127) is switched
- * on for a particular channel, we record the time that it
- * was turned on in the notechan array. As there are 16 channels
- * and 128 pitches, we initialize an array 128*16 = 2048 elements
- * long.
-**/
-void init_notechan()
-{
-/* signal that there are no active notes */
- int i;
- for (i = 0; i < 2048; i++) notechan[i] = -1;
-}
 
 
 
@@ -794,7 +782,7 @@ void stats_trackstart()
      }
  if (noOutput == 0) printf("trk %d \n",tracknum);
 
- for (i=0;i<2048;i++) lastTick[i] = -1;
+ for (i=0;i<NOTEKEYS;i++) lastTick[i] = -1;
  for (i=0;i<17;i++) channel_used_in_track[i] = 0; /* [SS] 2023-09-06 */
  for (i=0;i<204;i++) chanpitchhistogram[i] = 0;  /* [SS] 2023-09-13 */
 }
@@ -948,7 +936,7 @@ void stats_noteon(int chan,int pitch,int vol)
 	 
  if (abs(Mf_currtime - last_on_tick[chan+1]) < chordthreshold) trkdata.chordcount[chan+1]++;
  else trkdata.notecount[chan+1]++; /* [SS] 2019-08-02 */
- lastTick[chan*128 + pitch] = Mf_currtime;
+ lastTick[notekey(chan,pitch)] = Mf_currtime;
  last_on_tick[chan+1] = Mf_currtime; /* [SS] 2019-08-02 */
  /* last_on_tick not updated by stats_noteoff */
 
@@ -997,12 +985,12 @@ void stats_noteoff(int chan,int pitch,int vol)
   int length;
   int program;
   /* ignore if there was no noteon */
-  if (lastTick[chan*128+pitch] == -1) return;
-  length = Mf_currtime - lastTick[chan*128+pitch];
+  if (lastTick[notekey(chan,pitch)] == -1) return;
+  length = Mf_currtime - lastTick[notekey(chan,pitch)];
   trkdata.notelength[chan+1] += length;
   trkdata.notelengthmax[chan+1] = max(trkdata.notelengthmax[chan+1],length);
   trkdata.notelengthmin[chan+1] = min(trkdata.notelengthmin[chan+1],length);
-  //if (length < 3) printf("chan = %d  lasttick = %d currtime = %ld\n",chan,lastTick[chan*128+pitch],Mf_currtime);
+  //if (length < 3) printf("chan = %d  lasttick = %d currtime = %ld\n",chan,lastTick[notekey(chan,pitch)],Mf_currtime);
   trkdata.lastNoteOff[chan+1] = Mf_currtime; /* [SS] 2022.08.22 */
   chnactivity[chan+1] += length;
   trkactivity[tracknum]++;
@@ -1012,11 +1000,11 @@ void stats_noteoff(int chan,int pitch,int vol)
   progactivity[program] += length;
   channel_active[chan+1]--;
   /* [SS] 2018-04-18 */
-  if(Mf_currtime > lastTick[chan*128+pitch] && channel_active[chan+1] == 0) 
-    lastTick[chan*128+pitch] = Mf_currtime; /* [SS] 2023.08.30 handle chords */
+  if(Mf_currtime > lastTick[notekey(chan,pitch)] && channel_active[chan+1] == 0) 
+    lastTick[notekey(chan,pitch)] = Mf_currtime; /* [SS] 2023.08.30 handle chords */
     
   if (length > 4800) {
-     lastTick[chan*128+pitch] = Mf_currtime; /* handle stuck note [SS] 2023.08.30 */
+     lastTick[notekey(chan,pitch)] = Mf_currtime; /* handle stuck note [SS] 2023.08.30 */
      channel_active[chan+1] = 0;
      }
 }
@@ -1249,6 +1237,167 @@ qsort(midievents,lastEvent,sizeof(struct eventstruc),int_compare_events);
 }
 
 
+/* [SS] 2026-10-18 loadEvents() decodes each track separately with
+   the cursor interface of midifile.c. The note onsets of a track are
+   already in time order, so the tracks are merged with a heap instead
+   of sorting midievents[] afterwards. Onsets at the same time keep the
+   order of the tracks, as the stable qsort in load_finish() did.
+*/
+struct trackonsets {
+  struct eventstruc *event;
+  int n;
+  int next;
+};
+
+static int onset_before(struct trackonsets *trk, int a, int b)
+/* heap order: earlier onset first, then lower track number */
+{
+  int ta, tb;
+  ta = trk[a].event[trk[a].next].onsetTime;
+  tb = trk[b].event[trk[b].next].onsetTime;
+  if (ta != tb) return ta < tb;
+  return a < b;
+}
+
+static void sift_down(int *heap, int nheap, int i, struct trackonsets *trk)
+{
+  int child, t;
+  for (;;) {
+    child = 2*i + 1;
+    if (child >= nheap) return;
+    if (child+1 < nheap && onset_before(trk, heap[child+1], heap[child]))
+      child = child + 1;
+    if (!onset_before(trk, heap[child], heap[i])) return;
+    t = heap[i]; heap[i] = heap[child]; heap[child] = t;
+    i = child;
+  }
+}
+
+static void free_trackonsets(struct trackonsets *trk, int ntracks)
+{
+  int t;
+  for (t = 0; t < ntracks; t++)
+    if (trk[t].event != NULL) free(trk[t].event);
+  free(trk);
+}
+
+int load_tracks(long filesize)
+/* Loads midievents[] from the file read by mf_loadfile(). Returns 0,  */
+/* having changed nothing, if the file is not laid out the way mfread() */
+/* expects or a track is corrupt; the caller then falls back to mfread().*/
+{
+  int format, ntrks, ldivision, ntracks;
+  int t, r, size, total, nheap, i;
+  long *tempos;
+  int ntempos, temposize;
+  long maxpulse;
+  int *heap;
+  struct trackonsets *trk, *tr;
+  struct mfcursor cur;
+  struct mfevent ev;
+  struct eventstruc *e;
+  struct mftrack info;
+
+  ntracks = mf_tracktable(&format, &ntrks, &ldivision);
+  if (ntracks <= 0) return 0;
+  if (ntracks > ntrks) ntracks = ntrks;
+  if (!mf_tracksregular(ntracks)) return 0;
+  /* with fewer tracks than the header says, mfread() reads to the end */
+  if (ntracks < ntrks) {
+    mf_trackinfo(ntracks-1, &info);
+    if (info.offset + info.length != filesize) return 0;
+  }
+
+  trk = (struct trackonsets *) calloc(ntracks, sizeof(struct trackonsets));
+  temposize = 16;
+  tempos = (long *) malloc(temposize*sizeof(long));
+  if (trk == NULL || tempos == NULL) {
+    printf("out of memory in load_tracks\n");
+    exit(1);
+  }
+  ntempos = 0;
+  maxpulse = 0;
+  total = 0;
+  for (t = 0; t < ntracks; t++) {
+    tr = &trk[t];
+    size = 0;
+    mf_opentrack(&cur, t);
+    while ((r = mf_nextevent(&cur, &ev)) == 1) {
+      if (ev.time > INT_MAX) {r = -1; break;}
+      if ((ev.status & 0xf0) == 0x90) {
+        if (maxpulse < ev.time) maxpulse = ev.time;
+        if (ev.data[1] < 1) continue;
+        if (tr->n >= size) {
+          size = (size == 0) ? 256 : 2*size;
+          tr->event = (struct eventstruc *)
+                      realloc(tr->event, size*sizeof(struct eventstruc));
+          if (tr->event == NULL) {
+            printf("out of memory in load_tracks\n");
+            exit(1);
+          }
+        }
+        e = &tr->event[tr->n];
+        e->onsetTime = (int) ev.time;
+        e->channel = ev.status & 0xf;
+        e->pitch = ev.data[0];
+        e->velocity = ev.data[1];
+        tr->n++;
+      } else if (ev.status == 0xff && ev.type == 0x51) {
+        if (ev.length < 3) {r = -1; break;}
+        if (ntempos >= temposize) {
+          temposize = 2*temposize;
+          tempos = (long *) realloc(tempos, temposize*sizeof(long));
+          if (tempos == NULL) {
+            printf("out of memory in load_tracks\n");
+            exit(1);
+          }
+        }
+        tempos[ntempos++] = ((long) ev.data[0] << 16) +
+                            ((long) ev.data[1] << 8) + (long) ev.data[2];
+      }
+    }
+    if (r < 0) {
+      free_trackonsets(trk, ntracks);
+      free(tempos);
+      return 0;
+    }
+    total = total + tr->n;
+  }
+
+  /* the file is good; do what the mfread() callbacks would have done */
+  load_header(format, ntrks, ldivision);
+  for (i = 0; i < ntempos; i++) record_tempo(tempos[i]);
+  free(tempos);
+  if (maxpulse > maximumPulse) maximumPulse = maxpulse;
+  if (lastEvent + total > 49999) {
+    printf("ran out of space in midievents structure\n");
+    exit(1);
+  }
+
+  heap = (int *) malloc((ntracks+1)*sizeof(int));
+  if (heap == NULL) {
+    printf("out of memory in load_tracks\n");
+    exit(1);
+  }
+  nheap = 0;
+  for (t = 0; t < ntracks; t++)
+    if (trk[t].n > 0) heap[nheap++] = t;
+  for (i = nheap/2 - 1; i >= 0; i--) sift_down(heap, nheap, i, trk);
+  while (nheap > 0) {
+    tr = &trk[heap[0]];
+    e = &tr->event[tr->next];
+    midievents[lastEvent++] = *e;
+    channel_active[e->channel+1]++;
+    tr->next++;
+    if (tr->next >= tr->n) heap[0] = heap[--nheap];
+    sift_down(heap, nheap, 0, trk);
+  }
+  free(heap);
+  free_trackonsets(trk, ntracks);
+  return 1;
+}
+
+
 void pulseHistogram() {
 int i,j;
 int pulsePosition;
@@ -2065,7 +2214,9 @@ void midistats(int argc, char *argv[])
 {
 initfunc_for_stats();
 Mf_getc = filegetc;
+mf_loadfile(F); /* [SS] 2026-10-18 */
 mfread();
+mf_freefile();
 if (noOutput == 0)  stats_finish(); 
 if (noOutput == 0) outputChannelSummary(); 
 if (noOutput == 1) outputChannelSummaryCsv();
@@ -2076,9 +2227,14 @@ int i;
 initfunc_for_loadNoteEvents();
 Mf_getc = filegetc;
 maximumPulse = 0;
-mfread();
-lastBeat = maximumPulse/division;
-load_finish();
+if (load_tracks(mf_loadfile(F))) { /* [SS] 2026-10-18 */
+  lastBeat = maximumPulse/division;
+} else {
+  mfread();
+  lastBeat = maximumPulse/division;
+  load_finish();
+}
+mf_freefile();
 if (pulseanalysis) pulseHistogram(); 
 if (percanalysis) {
 	drumanalysis();
@@ -38,6 +38,8 @@
 /* [JM] 2018-02-22 to handle strncasecmp() */
 #include <string.h>
 #include <limits.h>
+#include <time.h>
+#include <sys/stat.h>
 
 /* #define SIZE_ABBREVIATIONS ('Z' - 'H' + 1) [SS] 2016-09-20 */
 #define SIZE_ABBREVIATIONS 58
@@ -112,6 +114,16 @@ int decorators_passback[DECSIZE];
 */
 
 char inputline[512];		/* [SS] 2011-06-07 2012-11-22 */
+
+/* [SS] 2026-10-18 parsemusic() and parsenote() classify each character
+ * of a music line with a single table lookup instead of searching the
+ * strings "_^=" and decorations[] with strchr.
+ */
+#define CC_NOTE 1		/* may start a note: a-g A-G _ ^ = or a decoration */
+#define CC_DECORATION 2		/* one of the characters in decorations[] */
+static unsigned char charclass[256];
+static unsigned char decoration_index[256];
+static int charclass_ready = 0;
 char *linestart;		/* [SS] 2011-07-18 */
 int lineposition;		/* [SS] 2011-07-18 */
 char timesigstring[16];		/* [SS] 2011-08-19 links with stresspat.c */
@@ -258,6 +270,441 @@ freevstring (struct vstring *s)
   s->limit = 0;
 }
 
+/* [SS] 2026-10-18 The stringarena routines replace addstring() for
+   text which is only needed until the end of the current tune. The
+   strings are packed into large blocks and released in one step by
+   cleararena(), which keeps the first block for the next tune.
+*/
+#define ARENABLOCK 16384
+
+static char *
+arenaalloc (struct stringarena *a, long len)
+/* returns space for len bytes in a */
+{
+  struct arenablock *b;
+  long size;
+
+  b = a->blocks;
+  if ((b == NULL) || (b->used + len > b->size))
+    {
+      size = ARENABLOCK;
+      if ((b != NULL) && (b->size >= size))
+	size = 2 * b->size;
+      while (size < len)
+	size = 2 * size;
+      b = (struct arenablock *) checkmalloc (sizeof (struct arenablock) + size);
+      b->size = size;
+      b->used = 0;
+      b->next = a->blocks;
+      a->blocks = b;
+    };
+  b->used = b->used + len;
+  return b->data + b->used - len;
+}
+
+static unsigned long
+arenahash (char *s)
+/* FNV-1a hash of s */
+{
+  unsigned long h;
+
+  h = 2166136261UL;
+  while (*s != '\0')
+    {
+      h = (h ^ (unsigned char) *s) * 16777619UL;
+      s++;
+    };
+  return h;
+}
+
+void
+initarena (struct stringarena *a)
+/* sets up an empty arena */
+{
+  a->blocks = NULL;
+  a->tablesize = 256;
+  a->count = 0;
+  a->table = (char **) checkmalloc (a->tablesize * sizeof (char *));
+  memset (a->table, 0, a->tablesize * sizeof (char *));
+}
+
+static void
+arenarehash (struct stringarena *a)
+/* doubles the size of the hash table */
+{
+  char **old;
+  long oldsize, i, j;
+
+  old = a->table;
+  oldsize = a->tablesize;
+  a->tablesize = 2 * oldsize;
+  a->table = (char **) checkmalloc (a->tablesize * sizeof (char *));
+  memset (a->table, 0, a->tablesize * sizeof (char *));
+  for (i = 0; i < oldsize; i++)
+    {
+      if (old[i] != NULL)
+	{
+	  j = (long) (arenahash (old[i]) & (a->tablesize - 1));
+	  while (a->table[j] != NULL)
+	    j = (j + 1) & (a->tablesize - 1);
+	  a->table[j] = old[i];
+	};
+    };
+  free (old);
+}
+
+char *
+arenastring (struct stringarena *a, char *s)
+/* returns a copy of s held in a. If the same string has already */
+/* been stored since the last cleararena(), that copy is returned. */
+{
+  long j, len;
+  char *p;
+
+  j = (long) (arenahash (s) & (a->tablesize - 1));
+  while (a->table[j] != NULL)
+    {
+      if (strcmp (a->table[j], s) == 0)
+	return a->table[j];
+      j = (j + 1) & (a->tablesize - 1);
+    };
+  len = strlen (s) + 1;
+  p = arenaalloc (a, len);
+  memcpy (p, s, len);
+  a->table[j] = p;
+  a->count = a->count + 1;
+  if (2 * a->count > a->tablesize)
+    arenarehash (a);
+  return p;
+}
+
+char *
+arenaconcat (struct stringarena *a, char *s1, char *s2)
+/* returns s1 followed by s2 in a. The result is not interned. */
+{
+  long len1, len2;
+  char *p;
+
+  len1 = strlen (s1);
+  len2 = strlen (s2);
+  p = arenaalloc (a, len1 + len2 + 1);
+  memcpy (p, s1, len1);
+  memcpy (p + len1, s2, len2 + 1);
+  return p;
+}
+
+void
+cleararena (struct stringarena *a)
+/* releases all strings in a */
+{
+  struct arenablock *b, *next;
+
+  if (a->blocks != NULL)
+    {
+      b = a->blocks->next;
+      while (b != NULL)
+	{
+	  next = b->next;
+	  free (b);
+	  b = next;
+	};
+      a->blocks->next = NULL;
+      a->blocks->used = 0;
+    };
+  if (a->count > 0)
+    {
+      memset (a->table, 0, a->tablesize * sizeof (char *));
+      a->count = 0;
+    };
+}
+
+void
+freearena (struct stringarena *a)
+/* releases all memory held by a */
+{
+  cleararena (a);
+  if (a->blocks != NULL)
+    free (a->blocks);
+  a->blocks = NULL;
+  if (a->table != NULL)
+    free (a->table);
+  a->table = NULL;
+}
+
+/* [SS] 2026-10-18 The abcbuffer routines hold a complete abc file in
+   memory. Lines are cut in place by overwriting the end-of-line
+   character with a '\0', so parseline() is handed a pointer into the
+   buffer instead of a copy built up one character at a time.
+*/
+int
+readabcbuffer (FILE * fp, struct abcbuffer *b)
+/* reads everything remaining in fp into b. Works for pipes as */
+/* well as files since the buffer is grown as needed.          */
+{
+  long limit;
+  size_t got;
+  char *p;
+
+  b->len = 0;
+  b->pos = 0;
+  b->eol = 0;
+  limit = 65536;
+  b->st = (char *) checkmalloc (limit + 1);
+  while ((got = fread (b->st + b->len, 1, limit - b->len, fp)) > 0)
+    {
+      b->len = b->len + (long) got;
+      if (b->len == limit)
+        {
+          limit = limit * 2;
+          p = (char *) realloc (b->st, limit + 1);
+          if (p == NULL)
+            {
+              printf ("Out of memory error - malloc failed!\n");
+              exit (0);
+            };
+          b->st = p;
+        };
+    };
+  *(b->st + b->len) = '\0';
+  return ferror (fp) ? 0 : 1;
+}
+
+int
+openabcbuffer (char *name, struct abcbuffer *b)
+/* loads the named file (or stdin) into b. Returns 0 on failure. */
+{
+  FILE *fp;
+  int success;
+
+  if ((strcmp (name, "stdin") == 0) || (strcmp (name, "-") == 0))
+    {
+      return readabcbuffer (stdin, b);
+    };
+  fp = fopen (name, "rb");
+  if (fp == NULL)
+    {
+      b->st = NULL;
+      return 0;
+    };
+  success = readabcbuffer (fp, b);
+  fclose (fp);
+  return success;
+}
+
+char *
+nextabcline (struct abcbuffer *b)
+/* returns the next line of b with the end of line removed, or */
+/* NULL when the buffer is exhausted. Recognizes \n or \r or   */
+/* \r\n or \n\r as end of line so that DOS, unix and Mac files */
+/* all work.                                                   */
+{
+  char *start, *p, *end;
+
+  if (b->pos >= b->len)
+    return NULL;
+  start = b->st + b->pos;
+  end = b->st + b->len;
+  p = start;
+  while ((p < end) && (*p != '\n') && (*p != '\r'))
+    p++;
+  if (p == end)
+    {
+      b->eol = 0;
+      b->pos = b->len;
+      return start;
+    };
+  b->eol = 1;
+  if ((p + 1 < end) &&
+      (((*p == '\n') && (*(p + 1) == '\r')) ||
+       ((*p == '\r') && (*(p + 1) == '\n'))))
+    {
+      *p++ = '\0';
+    };
+  *p = '\0';
+  b->pos = (long) (p - b->st) + 1;
+  return start;
+}
+
+static int
+isrefnoline (char *p, char *end, int *xref)
+/* checks whether the line starting at p is an X: field in the */
+/* form that parseline() passes on to parsefield()             */
+{
+  while ((p < end) && ((*p == ' ') || (*p == TAB)))
+    p++;
+  if ((p == end) || (*p != 'X'))
+    return 0;
+  p++;
+  while ((p < end) && ((*p == ' ') || (*p == TAB)))
+    p++;
+  if ((p == end) || (*p != ':'))
+    return 0;
+  p++;
+  if ((p < end) && ((*p == ':') || (*p == '|')))
+    return 0;
+  while ((p < end) && ((*p == ' ') || (*p == TAB)))
+    p++;
+  *xref = 0;
+  while ((p < end) && (*p >= '0') && (*p <= '9'))
+    {
+      *xref = *xref * 10 + (*p - '0');
+      p++;
+    };
+  return 1;
+}
+
+static int
+warnfieldline (char *line, char *end)
+/* [SS] 2026-10-18 checks whether the line starting at line is a */
+/* field which parseline() warns about even while the parser is  */
+/* switched off, i.e. it has whitespace before the : or may be a */
+/* :| repeat.                                                    */
+{
+  char *p;
+
+  p = line;
+  while ((p < end) && ((*p == ' ') || (*p == TAB)))
+    p++;
+  if ((p == end) || (strchr ("ABCDEFGHIKLMNOPQRSTUVdwsWXZ+", *p) == NULL))
+    return 0;
+  p++;
+  while ((p < end) && ((*p == ' ') || (*p == TAB)))
+    p++;
+  if ((p == end) || (*p != ':'))
+    return 0;
+  if ((line + 1 < end) && (*(line + 1) != ':'))
+    return 1;
+  return ((p + 1 < end) && ((*(p + 1) == ':') || (*(p + 1) == '|')));
+}
+
+static void
+addtuneentry (struct abctune **tunes, int *nentries, int *limit,
+	      long offset, int lineno, int xref)
+/* appends an entry to the table built by scanabcbuffer() */
+{
+  struct abctune *grown;
+
+  if (*nentries == *limit)
+    {
+      *limit = *limit * 2;
+      grown = (struct abctune *) realloc (*tunes,
+				    *limit * sizeof (struct abctune));
+      if (grown == NULL)
+	{
+	  printf ("Out of memory error - malloc failed!\n");
+	  exit (0);
+	};
+      *tunes = grown;
+    };
+  (*tunes)[*nentries].offset = offset;
+  (*tunes)[*nentries].lineno = lineno;
+  (*tunes)[*nentries].xref = xref;
+  *nentries = *nentries + 1;
+}
+
+static struct abctune *
+scanabcbuffer (struct abcbuffer *b, int *nentries, int stops)
+/* [SS] 2026-10-18 scans the unread part of b without parsing      */
+/* anything and returns a table giving the position, line number   */
+/* and reference number of every X: field. Line numbers count from */
+/* 1 at the current position of b. If stops is non-zero the table  */
+/* also holds every blank line, every line containing a % and    */
+/* every field which draws a warning, with xref set to -1,         */
+/* followed by an entry for the end of the buffer. These are the   */
+/* lines which matter while the parser is switched off; see        */
+/* parsefile().                                                    */
+{
+  struct abctune *tunes;
+  int limit;
+  int fileline;
+  int xref;
+  int isstop, blank, comment;
+  char *p, *start, *end;
+
+  *nentries = 0;
+  limit = 64;
+  tunes = (struct abctune *) checkmalloc (limit * sizeof (struct abctune));
+  p = b->st + b->pos;
+  end = b->st + b->len;
+  fileline = 1;
+  while (p < end)
+    {
+      start = p;
+      isstop = isrefnoline (p, end, &xref);
+      if (!isstop)
+	xref = -1;
+      blank = 1;
+      comment = 0;
+      while ((p < end) && (*p != '\n') && (*p != '\r'))
+	{
+	  if (*p == '%')
+	    comment = 1;
+	  else if ((*p != ' ') && (*p != TAB))
+	    blank = 0;
+	  p++;
+	};
+      if (stops && (blank || comment || warnfieldline (start, p)))
+	isstop = 1;
+      if (isstop)
+	addtuneentry (&tunes, nentries, &limit,
+		      (long) (start - b->st), fileline, xref);
+      if ((p + 1 < end) &&
+	  (((*p == '\n') && (*(p + 1) == '\r')) ||
+	   ((*p == '\r') && (*(p + 1) == '\n'))))
+	p++;
+      p++;
+      fileline = fileline + 1;
+    };
+  if (stops)
+    addtuneentry (&tunes, nentries, &limit, b->len, fileline, -1);
+  return tunes;
+}
+
+struct abctune *
+indexabcbuffer (struct abcbuffer *b, int *ntunes)
+/* [SS] 2026-10-18 returns the table of X: fields in the unread */
+/* part of b. See scanabcbuffer().                              */
+{
+  return scanabcbuffer (b, ntunes, 0);
+}
+
+void
+freeabcbuffer (struct abcbuffer *b)
+/* deallocates memory held by b */
+{
+  if (b->st != NULL)
+    {
+      free (b->st);
+      b->st = NULL;
+    };
+  b->len = 0;
+  b->pos = 0;
+}
+
+static void
+init_charclass ()
+/* [SS] 2026-10-18 fills in charclass[] and decoration_index[] */
+{
+  int i;
+  unsigned char c;
+
+  memset (charclass, 0, sizeof (charclass));
+  for (c = 'a'; c <= 'g'; c++)
+    charclass[c] = CC_NOTE;
+  for (c = 'A'; c <= 'G'; c++)
+    charclass[c] = CC_NOTE;
+  charclass['_'] = CC_NOTE;
+  charclass['^'] = CC_NOTE;
+  charclass['='] = CC_NOTE;
+  for (i = 0; decorations[i] != '\0'; i++)
+    {
+      c = (unsigned char) decorations[i];
+      charclass[c] = CC_NOTE | CC_DECORATION;
+      decoration_index[c] = (unsigned char) i;
+    };
+  charclass_ready = 1;
+}
+
 void
 parseron ()
 {
@@ -1742,9 +2189,9 @@ parsenote (char **s)
       if (!inchordflag)
 	decorators_passback[i] = 0;	/* [SS] 2012-03-30 */
     }
-  while (strchr (decorations, **s) != NULL)
+  while (charclass[(unsigned char) **s] & CC_DECORATION) /* [SS] 2026-10-18 */
     {
-      t = strchr (decorations, **s) - decorations;
+      t = decoration_index[(unsigned char) **s];
       decorators[t] = 1;
       *s = *s + 1;
     };
@@ -2032,7 +2479,8 @@ parse_precomment (char *s)
   char *p;
   int success;
 
-  success = sscanf (s, "%%%%abc-version %3s", abcversion); /* [SS] 2014-08-11 */
+  if (strncmp (s, "%%abc-version", 13) == 0) /* [SS] 2026-10-18 */
+    success = sscanf (s, "%%%%abc-version %3s", abcversion); /* [SS] 2014-08-11 */
   if (*s == '%')
     {
       p = s + 1;
@@ -2045,23 +2493,177 @@ parse_precomment (char *s)
     };
 }
 
-/* [SS] 2017-12-10 */
-FILE * parse_abc_include (char *s)
+/* [SS] 2026-10-18 files loaded by %%abc-include are kept in memory
+ * and reused for as long as their modification time is unchanged, so
+ * a header which is included by every tune of a collection is only
+ * read and cut into lines once. The parser and the event_X() routines
+ * may write into the line they are given (e.g. parsefield() cuts off
+ * a trailing comment), so each cached line is handed over in
+ * includeline rather than in place. The cache is released by
+ * free_abc_includes() at the end of parsefile().
+ */
+struct abcinclude {
+  char name[80];
+  time_t mtime;
+  struct abcbuffer text;	/* contents of the file, cut into lines */
+  long *lines;			/* offset of each line in text */
+  int nlines;
+  int active;			/* file is currently being included */
+  struct abcinclude *next;
+};
+
+static struct abcinclude *includecache = NULL;
+static char *includeline = NULL;	/* line being parsed */
+static long includelinesize = 0;
+
+void parseline (char *line);
+
+static void
+clear_abc_include (struct abcinclude *inc)
+/* releases the text held by a cache entry */
+{
+  freeabcbuffer (&inc->text);
+  if (inc->lines != NULL)
+    free (inc->lines);
+  inc->lines = NULL;
+  inc->nlines = 0;
+}
+
+static struct abcinclude *
+load_abc_include (char *name)
+/* returns the cache entry for the named file, (re)loading it if */
+/* necessary. Returns NULL if the file cannot be read. An entry  */
+/* which is being included is returned as it is: its text is     */
+/* still in use by parse_abc_include().                          */
+{
+  struct stat status;
+  struct abcinclude *inc;
+  char *line;
+  int limit;
+
+  inc = includecache;
+  while ((inc != NULL) && (strcmp (inc->name, name) != 0))
+    inc = inc->next;
+  if ((inc != NULL) && inc->active)
+    return inc;
+  if (stat (name, &status) != 0)
+    return NULL;
+  if (inc == NULL)
+    {
+      inc = (struct abcinclude *) checkmalloc (sizeof (struct abcinclude));
+      strcpy (inc->name, name);
+      inc->text.st = NULL;
+      inc->lines = NULL;
+      inc->nlines = 0;
+      inc->active = 0;
+      inc->next = includecache;
+      includecache = inc;
+    }
+  else if ((inc->text.st != NULL) && (inc->mtime == status.st_mtime))
+    {
+      return inc;
+    };
+  clear_abc_include (inc);
+  inc->mtime = status.st_mtime;
+  if (openabcbuffer (name, &inc->text) == 0)
+    {
+      clear_abc_include (inc);
+      return NULL;
+    };
+  limit = 64;
+  inc->lines = (long *) checkmalloc (limit * sizeof (long));
+  while ((line = nextabcline (&inc->text)) != NULL)
+    {
+      if (inc->nlines == limit)
+	{
+	  long *grown;
+
+	  limit = limit * 2;
+	  grown = (long *) realloc (inc->lines, limit * sizeof (long));
+	  if (grown == NULL)
+	    {
+	      printf ("Out of memory error - malloc failed!\n");
+	      exit (0);
+	    };
+	  inc->lines = grown;
+	};
+      inc->lines[inc->nlines] = (long) (line - inc->text.st);
+      inc->nlines = inc->nlines + 1;
+    };
+  return inc;
+}
+
+static void
+free_abc_includes ()
+/* releases all the files held by the %%abc-include cache */
+{
+  struct abcinclude *inc;
+
+  while (includecache != NULL)
+    {
+      inc = includecache;
+      includecache = inc->next;
+      clear_abc_include (inc);
+      free (inc);
+    };
+  if (includeline != NULL)
+    free (includeline);
+  includeline = NULL;
+  includelinesize = 0;
+}
+
+/* [SS] 2017-12-10 2026-10-18 */
+int parse_abc_include (char *s)
+/* if s is a %%abc-include directive, the lines of the named file */
+/* are parsed in its place and 1 is returned. Included files may  */
+/* themselves include other files, but not one which is already   */
+/* being included.                                                */
 {
   char includefilename[80];
-  FILE *includehandle;
   int success;
+  struct abcinclude *inc;
+  char *line;
+  long len;
+  int i;
+
   success = sscanf (s, "%%%%abc-include %79s", includefilename); /* [SS] 2014-08-11 */
-  if (success == 1) {
-    /* printf("opening include file %s\n",includefilename); */
-    includehandle = fopen(includefilename,"r");
-    if (includehandle == NULL)
+  if (success != 1)
+    return 0;
+  /* printf("opening include file %s\n",includefilename); */
+  inc = load_abc_include (includefilename);
+  if (inc == NULL)
     {
       printf ("Failed to open include file %s\n", includefilename);
+      return 0;
     };
-    return includehandle;
-    }
-  return NULL; 
+  if (inc->active)
+    {
+      event_error ("Not allowed to recurse include file");
+      return 1;
+    };
+  if (parsing)
+    event_linebreak ();
+  inc->active = 1;
+  for (i = 0; i < inc->nlines; i++)
+    {
+      line = inc->text.st + inc->lines[i];
+      len = (long) strlen (line);
+      if (len + 1 > includelinesize)
+	{
+	  if (includeline != NULL)
+	    free (includeline);
+	  includelinesize = len + 81;
+	  includeline = (char *) checkmalloc (includelinesize);
+	};
+      memcpy (includeline, line, len + 1);
+      if (parse_abc_include (includeline))
+	continue;
+      parseline (includeline);
+      if (parsing)
+	event_linebreak ();
+    };
+  inc->active = 0;
+  return 1;
 }
 
 /* Function mofied for umlaut handling JA 20 May 2022 */
@@ -2896,15 +3498,13 @@ parsemusic (char *field)
   for (i = 0; i < DECSIZE; i++)
     decorators[i] = 0;		/* [SS] 2012-03-30 */
 
+  if (!charclass_ready)
+    init_charclass ();
   event_startmusicline ();
   endchar = ' ';
-  comment = field;
   iscomment = 0;
-  while ((*comment != '\0') && (*comment != '%'))
-    {
-      comment = comment + 1;
-    };
-  if (*comment == '%')
+  comment = strchr (field, '%'); /* [SS] 2026-10-18 */
+  if (comment != NULL)
     {
       iscomment = 1;
       *comment = '\0';
@@ -2928,8 +3528,7 @@ parsemusic (char *field)
          /* ignore dotted bar */
          }
 
-      if (((*p >= 'a') && (*p <= 'g')) || ((*p >= 'A') && (*p <= 'G')) ||
-	  (strchr ("_^=", *p) != NULL) || (strchr (decorations, *p) != NULL))
+      if (charclass[(unsigned char) *p] & CC_NOTE) /* [SS] 2026-10-18 */
 	{
 	  parsenote (&p);
 	}
@@ -3286,12 +3885,8 @@ parsemusic (char *field)
 		p = p + 1;
 		s = p;
 		initvstring (&instruction);
-		while ((*p != endcode) && (*p != '\0'))
-		  {
-		    addch (*p, &instruction);
-		    p = p + 1;
-		  };
-		if (*p != endcode)
+		p = strchr (s, endcode); /* [SS] 2026-10-18 */
+		if (p == NULL)
 		  {
 		    p = s;
 		    if (checkend (s))
@@ -3306,6 +3901,9 @@ parsemusic (char *field)
 		  }
 		else
 		  {
+		    *p = '\0';
+		    addtext (s, &instruction);
+		    *p = endcode;
 		    event_instruction (instruction.st);
 		    p = p + 1;
 		  };
@@ -3381,12 +3979,15 @@ parseline (char *line)
   char *p, *q;
 
   /* [SS] 2020-01-03 2021-02-21 */
-  if (strstr(line,"%%begintext") != NULL) {
+  /* [SS] 2026-10-18 only lines containing a % need to be searched */
+  if (strchr(line,'%') != NULL) {
+    if (strstr(line,"%%begintext") != NULL) {
 	  ignore_line = 1;
           }
-  if (strstr(line,"%%endtext") != NULL) {
+    if (strstr(line,"%%endtext") != NULL) {
 	  ignore_line = 0;
           }
+    }
   /* [SS] 2021-05-09 */
   if (strcmp(line,"%%beginps") == 0) {
 	  ignore_line = 1;
@@ -3511,196 +4112,96 @@ parsefile (char *name)
 /* top-level routine for parsing file */
 /* [SS] 2017-12-10 In order to allow including the directive
    "%%abc-include includefile.abc" to insert the includedfile.abc,
-   we switch the file handle fp to link to the includefile.abc and switch
-   back to the original file handle when we reach the end of file
-   of includefile.abc. Thus we keep track of the original handle
-   using fp_last.
+   the lines of includefile.abc are parsed in place of the directive
+   before continuing with the original file.
+   [SS] 2026-10-18 The whole file is now read into memory and the
+   lines are cut in place (see nextabcline()) rather than being
+   assembled character by character with getc(). scanabcbuffer()
+   first lists the lines which still matter while the parser is
+   switched off: X: fields, blank lines, lines containing a comment
+   or directive and malformed fields which draw a warning. Whenever one of these leaves the parser
+   switched off (e.g. the tune was not selected by the event_refno()
+   routine of the program) the buffer jumps straight to the next
+   such line, so the rest of an unselected tune is never read.
 */
 {
-  FILE *fp;
-  FILE *fp_last,*fp_include; /* [SS] 2017-12-10 */
-  int reading;
+  struct abcbuffer source;
+  struct abctune *stops;
+  int nstops, nextstop, atstop;
+  char *line;
   int fileline;
-  int last_position = 0; /* [SDG] 2020-06-03 */
-  struct vstring line;
-  /* char line[MAXLINE]; */
-  int t;
-  int lastch, done_eol;
-  int err;
-
-  fp_last = NULL; /* [SS] 2017-12-10 */
 
   /* printf("parsefile called %s\n", name); */
-  /* The following code permits abc2midi to read abc from stdin */
-  if ((strcmp (name, "stdin") == 0) || (strcmp (name, "-") == 0))
-    {
-      fp = stdin;
-    }
-  else
-    {
-      fp = fopen (name, "r");
-    };
-  if (fp == NULL)
+  /* openabcbuffer permits abc2midi to read abc from stdin */
+  if (openabcbuffer (name, &source) == 0)
     {
       printf ("Failed to open file %s\n", name);
       exit (1);
     };
+  stops = scanabcbuffer (&source, &nstops, 1);
+  nextstop = 0;
   inhead = 0;
   inbody = 0;
   parseroff ();
-  reading = 1;
-  line.limit = 4;
-  initvstring (&line);
   fileline = 1;
-  done_eol = 0;
-  lastch = '\0';
-  while (reading)
+  while ((line = nextabcline (&source)) != NULL)
     {
-      t = getc (fp);
-      if (t == EOF)
+      atstop = -1;
+      if ((long) (line - source.st) == stops[nextstop].offset)
 	{
-	  reading = 0;
-	  if (line.len > 0)
-	    {
-	      parseline (line.st);
-	      fileline = fileline + 1;
-	      lineno = fileline;
-	      if (parsing)
-		event_linebreak ();
-	    };
-          if (fp_last != NULL) {  /* [SS] 2017-12-10 */
-            fclose(fp);
-            fp = fp_last;
-            err = fseek(fp,last_position,SEEK_SET);
-            /*printf("fseek return err = %d\n",err);*/
-            reading = 1;
-            fp_last = NULL;
-            }
-	}
-      else
+	  atstop = nextstop;
+	  nextstop = nextstop + 1;
+	};
+      if (parse_abc_include (line))	/* [SS] 2017-12-10 */
+	continue;
+      parseline (line);
+      fileline = fileline + 1;
+      lineno = fileline;
+      if (parsing)
+	event_linebreak ();
+      else if ((atstop != -1) && (ignore_line == 0))
 	{
-	  /* recognize  \n  or  \r  or  \r\n  or  \n\r  as end of line */
-	  /* should work for DOS, unix and Mac files */
-	  if ((t != '\n') && (t != '\r'))
-	    {
-	      addch ((char) t, &line);
-	      done_eol = 0;
-	    }
-	  else
-	    {
-	      if ((done_eol) && (((t == '\n') && (lastch == '\r')) ||
-				 ((t == '\r') && (lastch == '\n'))))
-		{
-		  done_eol = 0;
-		  /* skip this character */
-		}
-	      else
-		{
-                 /* reached end of line */
-                 fp_include = parse_abc_include (line.st);/* [SS] 2017-12-10 */
-                 if (fp_include == NULL) { 
-		    parseline (line.st);
-		    clearvstring (&line);
-                    if (fp_last == NULL) {
-		      fileline = fileline + 1;
-		      lineno = fileline;
-                      }
-		    if (parsing)
-		      event_linebreak ();
-		    done_eol = 1;
-                    } else {
-                    if (fp_last == NULL) {
-                      last_position = ftell(fp);
-                      /*printf("last position = %d\n",last_position);*/
-                      fp_last = fp;
-                      fp = fp_include;
-		      if (parsing)
-		        event_linebreak ();
-		      done_eol = 1;
-		      clearvstring (&line);
-                      } else {
-                      event_error ("Not allowed to recurse include file");
-                      }
-                    }
-		};
-	    };
-	  lastch = t;
+	  /* skip to the next line which can have an effect */
+	  fileline = fileline + stops[nextstop].lineno -
+	    stops[atstop].lineno - 1;
+	  lineno = fileline;
+	  source.pos = stops[nextstop].offset;
 	};
     };
-  fclose (fp);
+  free (stops);
+  freeabcbuffer (&source);
+  free_abc_includes ();
   event_eof ();
-  freevstring (&line);
   if (parsing_started == 0)
     event_error ("No tune processed. Possible missing X: field");
 }
 
 
 int
-parsetune (FILE * fp)
-/* top-level routine for parsing file */
+parsetune (struct abcbuffer *source)
+/* top-level routine for parsing the next tune in source */
+/* returns EOF when source has been used up.              */
 {
-  struct vstring line;
-  /* char line[MAXLINE]; */
-  int t;
-  int lastch, done_eol;
+  char *line;
 
   inhead = 0;
   inbody = 0;
   parseroff ();
   intune = 1;
-  line.limit = 4;
-  initvstring (&line);
-  done_eol = 0;
-  lastch = '\0';
   do
     {
-      t = getc (fp);
-      if (t == EOF)
-	{
-	  if (line.len > 0)
-	    {
-	      printf ("%s\n", line.st);
-	      parseline (line.st);
-	      fileline_number = fileline_number + 1;
-	      lineno = fileline_number;
-	      event_linebreak ();
-	    };
-	  break;
-	}
-      else
-	{
-	  /* recognize  \n  or  \r  or  \r\n  or  \n\r  as end of line */
-	  /* should work for DOS, unix and Mac files */
-	  if ((t != '\n') && (t != '\r'))
-	    {
-	      addch ((char) t, &line);
-	      done_eol = 0;
-	    }
-	  else
-	    {
-	      if ((done_eol) && (((t == '\n') && (lastch == '\r')) ||
-				 ((t == '\r') && (lastch == '\n'))))
-		{
-		  done_eol = 0;
-		  /* skip this character */
-		}
-	      else
-		{
-		  /* reached end of line */
-		  parseline (line.st);
-		  clearvstring (&line);
-		  fileline_number = fileline_number + 1;
-		  lineno = fileline_number;
-		  event_linebreak ();
-		  done_eol = 1;
-		};
-	    };
-	  lastch = t;
-	};
+      line = nextabcline (source);
+      if (line == NULL)
+	return EOF;
+      if (!source->eol)
+	printf ("%s\n", line);
+      parseline (line);
+      fileline_number = fileline_number + 1;
+      lineno = fileline_number;
+      event_linebreak ();
     }
   while (intune);
-  freevstring (&line);
-  return t;
+  return '\n';
 }
 
 /*
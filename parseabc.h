@@ -53,6 +53,39 @@ struct fraction {
   int denom;
 };
 
+/* holds a complete abc file in memory; see nextabcline() */
+struct abcbuffer {
+  char *st;   /* file contents followed by '\0' */
+  long len;   /* number of bytes read */
+  long pos;   /* offset of the next unread line */
+  int eol;    /* last line returned was terminated by end of line */
+};
+
+/* [SS] 2026-10-18 strings which live until the end of a tune are */
+/* allocated from a stringarena and released together by cleararena(). */
+/* Strings added with arenastring() are interned, i.e. identical      */
+/* strings share storage, so they must not be modified.               */
+struct arenablock {
+  struct arenablock *next;
+  long size;
+  long used;
+  char data[1];
+};
+
+struct stringarena {
+  struct arenablock *blocks;  /* most recently allocated block first */
+  char **table;               /* hash table of interned strings */
+  long tablesize;             /* power of 2 */
+  long count;                 /* strings in table */
+};
+
+/* entry in the table of tunes built by indexabcbuffer() */
+struct abctune {
+  long offset; /* position of the X: line in the buffer */
+  int lineno;  /* line number of the X: line */
+  int xref;    /* reference number */
+};
+
 /* non-zero values for append in words_fn() */
 #define W_PLUS_FIELD 1
 #define PLUS_FIELD 2
@@ -75,6 +108,16 @@ extern void print_inputline(void);
 extern void print_inputline_nolinefeed(void);
 extern void init_timesig(timesig_details_t *timesig);
 extern void copy_timesig(timesig_details_t *destination, timesig_details_t *source);
+extern int readabcbuffer(FILE *fp, struct abcbuffer *b);
+extern int openabcbuffer(char *name, struct abcbuffer *b);
+extern char *nextabcline(struct abcbuffer *b);
+extern void freeabcbuffer(struct abcbuffer *b);
+extern struct abctune *indexabcbuffer(struct abcbuffer *b, int *ntunes);
+extern void initarena(struct stringarena *a);
+extern char *arenastring(struct stringarena *a, char *s);
+extern char *arenaconcat(struct stringarena *a, char *s1, char *s2);
+extern void cleararena(struct stringarena *a);
+extern void freearena(struct stringarena *a);
 #else
 extern int readnump();
 extern int readsnump();
@@ -92,6 +135,16 @@ extern void event_normal_tone();
 extern void print_inputline_nolinefeed();
 extern void init_timesig();
 extern void copy_timesig();
+extern int readabcbuffer();
+extern int openabcbuffer();
+extern char *nextabcline();
+extern void freeabcbuffer();
+extern struct abctune *indexabcbuffer();
+extern void initarena();
+extern char *arenastring();
+extern char *arenaconcat();
+extern void cleararena();
+extern void freearena();
 #endif
 extern void parseron();
 extern void parseroff();
@@ -178,7 +231,7 @@ extern void print_voicecodes(void);
 extern void init_abbreviations();
 extern void free_abbreviations();
 extern void parsefile(char * name);
-extern int parsetune(FILE * fp);
+extern int parsetune(struct abcbuffer *source);
 #else
 extern void event_init();
 extern void event_text();
@@ -24,8 +24,10 @@
  * Notes due to finish in the future are held in a queue (linked list)
  * in time order. Qhead points to the head of the list and addtoQ() 
  * adds a note to the list. The unused elements of array Q are held
- * in another linked list pointed to by freehead. The tail is pointed
- * to by freetail. removefromQ() removes an element (always from the
+ * in another linked list pointed to by freehead. Q grows when the
+ * free list runs out, up to QMAXSIZE notes sounding at once; beyond
+ * that a chord is assumed to be missing its ']' or '+'. The tail is
+ * pointed to by freetail. removefromQ() removes an element (always from the
  * head of the list) and adds it to the free list. Qinit() initializes
  * the queue and clearQ() outputs all the remaining notes at the end
  * of a track.
@@ -34,6 +36,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "queues.h"
 #include "abc.h"
 #include "genmidi.h"
@@ -43,7 +46,8 @@ void write_event_with_delay(int delta,int event_type,int channel,char* data,int
 
 /* queue for notes waiting to end */
 /* allows us to do general polyphony */
-#define QSIZE 50
+#define QSIZE 50   /* initial size of Q */
+#define QMAXSIZE 3200 /* [SS] 2026-10-18 Q does not grow beyond this */
 struct Qitem {
   int delay;
   int pitch;
@@ -51,7 +55,8 @@ struct Qitem {
   int effect;  /* [SS] 2012-12-11 */
   int next;
 };
-struct Qitem Q[QSIZE+1];
+struct Qitem *Q = NULL; /* [SS] 2026-10-18 grown by growQ() */
+int Qsize = 0;
 int Qhead, freehead, freetail;
 extern int totalnotedelay; /* from genmidi.c [SS] */
 extern int notedelay;      /* from genmidi.c [SS] */
@@ -61,10 +66,11 @@ extern int bendstate; /* from genmidi.c [SS] */
 /* [SS] 2014-09-10 */
 extern int benddata[256]; /* from genmidi.c [SS] 2015-09-10 2015-10-03 */
 extern int bendnvals;
-extern int controldata[3][256]; /* extended to 256 2015-10-03 */
-extern int controlnvals[2];
+extern int controldata[MAXLAYERS][256]; /* extended to 256 2015-10-03 */
+extern int controlnvals[MAXLAYERS];
 extern int controldefaults[128]; /* [SS] 2015-08-10 */
 extern int nlayers; /* [SS] 2015-08-20 */
+extern int envelope_generation; /* [SS] 2026-10-18 */
 
 void set_control_defaults() {
     int i;
@@ -87,6 +93,39 @@ void set_control_defaults() {
 /* at the same as specifiedy abc standard, so the delay of the*/
 /* other notes cached in the Q structure should be set to zero.*/
 
+static int growQ()
+/* [SS] 2026-10-18 doubles the size of Q and adds the new */
+/* elements to the free list. Elements keep their index.  */
+/* Returns 0 if Q has already reached QMAXSIZE.           */
+{
+  int i, newsize;
+  struct Qitem *newQ;
+
+  if (Qsize >= QMAXSIZE) {
+    return 0;
+  };
+  newsize = 2*Qsize;
+  if (newsize > QMAXSIZE) {
+    newsize = QMAXSIZE;
+  };
+  newQ = (struct Qitem *) realloc(Q, (newsize+1)*sizeof(struct Qitem));
+  if (newQ == NULL) {
+    event_fatal_error("Out of memory for note queue");
+    return 0;
+  };
+  Q = newQ;
+  for (i=Qsize; i<newsize-1; i++) {
+    Q[i].next = i + 1;
+  };
+  Q[newsize-1].next = freehead;
+  if (freehead == -1) {
+    freetail = newsize-1;
+  };
+  freehead = Qsize;
+  Qsize = newsize;
+  return 1;
+}
+
 void addtoQ(int num, int denom, int pitch, int chan, int effect, int d)
 {
   int i, done;
@@ -97,14 +136,13 @@ void addtoQ(int num, int denom, int pitch, int chan, int effect, int d)
 
   wait = ((div_factor*num)/denom) + d;
   /* find free space */
-  if (freehead == -1) {
+  if ((freehead == -1) && (growQ() == 0)) {
     /* printQ(); */
     event_error("Too many notes in chord - probably missing ']' or '+'");
     return;
-  } else {
-    i = freehead;
-    freehead = Q[freehead].next;
   };
+  i = freehead;
+  freehead = Q[freehead].next;
   Q[i].pitch = pitch;
   Q[i].chan = chan;
   Q[i].effect = effect;  /* [SS] 2012-12-11 */
@@ -203,25 +241,34 @@ void Qinit()
   int i;
 
   /* initialize queue of notes waiting to finish */
+  if (Q == NULL) {
+    Qsize = QSIZE;
+    Q = (struct Qitem *) malloc((Qsize+1)*sizeof(struct Qitem));
+    if (Q == NULL) {
+      event_fatal_error("Out of memory for note queue");
+    };
+  };
   Qhead = -1;
   freehead = 0;
-  for (i=0; i<QSIZE-1; i++) {
+  for (i=0; i<Qsize-1; i++) {
     Q[i].next = i + 1;
   };
-  Q[QSIZE-1].next = -1;
-  freetail = QSIZE-1;
+  Q[Qsize-1].next = -1;
+  freetail = Qsize-1;
 }
 
 void Qcheck()
 {
   int qfree, qused;
   int nextitem;
-  int used[QSIZE];
+  int *used;
   int i;
   int failed;
 
   failed = 0;
-  for (i=0; i<QSIZE; i++) {
+  used = (int *) malloc(Qsize*sizeof(int));
+  if (used == NULL) return;
+  for (i=0; i<Qsize; i++) {
     used[i] = 0;
   };
   qused = 0;
@@ -230,7 +277,7 @@ void Qcheck()
     qused = qused + 1;
     used[nextitem] = 1;
     nextitem = Q[nextitem].next;
-    if ((nextitem < -1) || (nextitem >= QSIZE)) {
+    if ((nextitem < -1) || (nextitem >= Qsize)) {
       failed = 1;
       printf("Queue corrupted Q[].next = %d\n", nextitem);
     };
@@ -241,16 +288,16 @@ void Qcheck()
     qfree = qfree + 1;
     used[nextitem] = 1;
     nextitem = Q[nextitem].next;
-    if ((nextitem < -1) || (nextitem >= QSIZE)) {
+    if ((nextitem < -1) || (nextitem >= Qsize)) {
       failed = 1;
       printf("Free Queue corrupted Q[].next = %d\n", nextitem);
     };
   };
-  if (qfree + qused < QSIZE) {
+  if (qfree + qused < Qsize) {
     failed = 1;
     printf("qfree = %d qused = %d\n", qused, qfree);
   };
-  for (i=0; i<QSIZE; i++) {
+  for (i=0; i<Qsize; i++) {
     if (used[i] == 0) {
       printf("Not used element %d\n", i);
       failed = 1;
@@ -260,6 +307,7 @@ void Qcheck()
     printf("freetail = %d, Q[freetail].next = %d\n", freetail, 
            Q[freetail].next);
   };
+  free(used);
   if (failed == 1) {
     printQ();
     event_fatal_error("Qcheck failed");
@@ -408,16 +456,6 @@ struct eventstruc {int time;
                    char data1;
                    char data2;};
 
-int int_compare_events(const void *a, const void *b) {
-   struct eventstruc *ia  = (struct eventstruc *)a;
-   struct eventstruc *ib  = (struct eventstruc *)b;
-   if (ib->time > ia->time) 
-       return -1;
-   else if (ia ->time > ib->time)
-       return  1;
-   else return 0; 
-   }
-
 void print_eventlist(struct eventstruc *list, int nsize) {
     int i;
     for (i = 0; i<nsize; i++) 
@@ -442,90 +480,199 @@ void output_eventlist (struct eventstruc *list, int nsize, int chan) {
         }
     } 
 
-/* [SS] 2015-08-01 */
+/* [SS] 2026-10-18 The events shaping a note depend only on the   */
+/* bendstring and controlstring data, on bendstate and on the      */
+/* length of the note. note_effect5() keeps the rendered events of */
+/* the last few note lengths so that repeated notes do not render  */
+/* them again. genmidi.c increments envelope_generation whenever   */
+/* the bend or control data change, which empties the cache.       */
+#define ENVCACHESIZE 8
+struct envelope {
+  int duration;     /* delta_time of the note */
+  int nevents;
+  int last_delta;   /* delay of the note off after the last event */
+  struct eventstruc *events;
+};
+static struct envelope envcache[ENVCACHESIZE];
+static int envcached = 0;   /* number of entries in use */
+static int envnext = 0;     /* entry to be replaced next */
+/* state the cached envelopes were made from */
+static int env_generation, env_bendstate;
+
+static void check_envelope_source()
+/* empties the cache if the bend or control data have changed */
+{
+  if ((envcached > 0) && (env_generation == envelope_generation) &&
+      (env_bendstate == bendstate)) return;
+  envcached = 0;
+  envnext = 0;
+  env_generation = envelope_generation;
+  env_bendstate = bendstate;
+}
+
+static int render_envelope(struct eventstruc *eventlist, int *last_delta,
+                           int *errors)
+/* Computes the pitch bend and controller events for a note of */
+/* length delta_time in time order. Returns the number of      */
+/* events or -1 if the controller number is invalid.           */
+{
+  struct eventstruc list[MAXLAYERS+1][256];
+  int nlist[MAXLAYERS+1], head[MAXLAYERS+1];
+  int delta=0,notetime,pitchbend; /* [SDG] 2020-06-03 */ 
+  int i,j,k;
+  int layer;
+  int controltype,controlval;
+
+  for (k=0; k<=MAXLAYERS; k++) {
+    nlist[k] = 0;
+    head[k] = 0;
+  };
+  *errors = 0;
+  pitchbend = bendstate;
+  if (bendnvals > 0) {
+    delta = delta_time/bendnvals;
+    notetime = 0;
+    for (i = 0; i <bendnvals; i++) {
+      pitchbend = benddata[i] + pitchbend;
+      if (pitchbend > 16383) {
+         event_error("pitchbend exceeds 16383");
+         pitchbend = 16383;
+         *errors = 1;
+         }
+      if (pitchbend < 0) {
+         event_error("pitchbend is less than 0");
+         pitchbend = 0;
+         *errors = 1;
+         }
+      list[0][i].time = notetime;
+      list[0][i].cmd = pitch_wheel;
+      list[0][i].data1 = pitchbend & 0x7f;
+      list[0][i].data2 = (pitchbend >> 7) & 0x7f;
+      notetime += delta;
+      } 
+    nlist[0] = bendnvals;
+    }
+
+  /* list[0] holds the bend, list[layer+1] each control layer */
+  for (layer=0;layer <= nlayers && layer < MAXLAYERS;layer++) {
+    if (controlnvals[layer] > 1) {
+      delta = delta_time/(controlnvals[layer] -1);
+      notetime = 0;
+      controltype = controldata[layer][0];
+      if (controltype > 127 || controltype < 0) {
+        event_error("controller must be in range 0 to 127");
+        return -1;
+        }
+
+      for (i = 1; i <controlnvals[layer]; i++) {
+        controlval = controldata[layer][i];
+        if (controlval < 0) {
+          event_error("control data must be zero or greater");
+          controlval = 0;
+          *errors = 1;
+          }
+        if (controlval > 127) {
+          event_error("control data must be less or equal to 127");
+          controlval = 127;
+          *errors = 1;
+          }
+        list[layer+1][i-1].time = notetime;
+        list[layer+1][i-1].cmd  = control_change;
+        list[layer+1][i-1].data1 = controltype;
+        list[layer+1][i-1].data2 = controlval;
+        notetime += delta;
+        }
+      nlist[layer+1] = controlnvals[layer] - 1;
+      }         
+    }
+
+  /* Each list is already in time order, so merge them. Events at */
+  /* the same time keep the order bend, layer 0, layer 1, ...      */
+  j = 0;
+  for (;;) {
+    k = -1;
+    for (i=0; i<=MAXLAYERS; i++) {
+      if (head[i] < nlist[i] &&
+          (k == -1 || list[i][head[i]].time < list[k][head[k]].time)) {
+        k = i;
+      };
+    };
+    if (k == -1) break;
+    eventlist[j] = list[k][head[k]];
+    head[k]++;
+    j++;
+  };
+
+  /* [SS] 2015-08-28 */
+  if (j > 0) {
+    *last_delta = delta - eventlist[j-1].time; /* [SS] 2017-06-10 */
+  } else {
+    *last_delta = delta;
+  };
+  return j;
+}
+
+/* [SS] 2015-08-01 2026-10-18 */
 void note_effect5(int chan)
 {
     /* This procedure merges the controlstring with the
        bendstring and uses it to shape the note. The control
-       commands are prepared and stored in the eventstruc
-       eventlist[] array, sorted chronologically and sent
-       to the MIDI file.
+       commands are prepared by render_envelope() in
+       chronological order and sent to the MIDI file.
     */
     struct eventstruc eventlist[1024]; /* extended to 1000 2015-10-03 */
-    int delta=0,notetime,pitchbend; /* [SDG] 2020-06-03 */ 
+    struct eventstruc *events;
+    struct envelope *env;
+    int nevents;
     int last_delta; /* [SS] 2017-06-10 */
+    int errors;
     int initial_bend; /* [SS] 2015-08-25 */
-    int i,j;
+    int i;
     int layer;
-    int controltype,controlval;
+    int controltype;
+    int pitchbend;
     char data[2];
 
-    j = 0; 
-    pitchbend = bendstate;
     initial_bend = bendstate;
-    if (bendnvals > 0) {
-        delta = delta_time/bendnvals;
-        notetime = 0;
-        for (i = 0; i <bendnvals; i++) {
-            pitchbend = benddata[i] + pitchbend;
-            if (pitchbend > 16383) {
-               event_error("pitchbend exceeds 16383");
-               pitchbend = 16383;
-               }
-            if (pitchbend < 0) {
-               event_error("pitchbend is less than 0");
-               pitchbend = 0;
-               }
-            eventlist[j].time = notetime;
-            eventlist[j].cmd = pitch_wheel;
-            eventlist[j].data1 = pitchbend & 0x7f;
-            eventlist[j].data2 = (pitchbend >> 7) & 0x7f;
-            notetime += delta;
-            j++;
-            } 
-      }
- 
-    for (layer=0;layer <= nlayers;layer++) {
-        if (controlnvals[layer] > 1) {
-            delta = delta_time/(controlnvals[layer] -1);
-            notetime = 0;
-            controltype = controldata[layer][0];
-            if (controltype > 127 || controltype < 0) {
-                event_error("controller must be in range 0 to 127");
-                return;
-                }
-    
-            for (i = 1; i <controlnvals[layer]; i++) {
-                controlval = controldata[layer][i];
-                if (controlval < 0) {
-                    event_error("control data must be zero or greater");
-                    controlval = 0;
-                    }
-                if (controlval > 127) {
-                    event_error("control data must be less or equal to 127");
-                    controlval = 127;
-                    }
-                eventlist[j].time = notetime;
-                eventlist[j].cmd  = control_change;
-                eventlist[j].data1 = controltype;
-                eventlist[j].data2 = controlval;
-                notetime += delta;
-                if (j < 1023) j++; /* [SS] increased to 999 2015-10-04 */
-                else event_error("eventlist too complex");
-               
-                }
-            }         
-        }
-
-    /* [SS] 2015-08-23 */
-    if (j > 1) {
-        qsort(eventlist,j,sizeof(struct eventstruc),int_compare_events);
-    /*print_eventlist(eventlist,j); */
-        }
-    output_eventlist(eventlist,j,chan);
+    check_envelope_source();
+    env = NULL;
+    for (i=0; i<envcached; i++) {
+      if (envcache[i].duration == delta_time) {
+        env = &envcache[i];
+        break;
+      };
+    };
+    if (env != NULL) {
+      events = env->events;
+      nevents = env->nevents;
+      last_delta = env->last_delta;
+    } else {
+      nevents = render_envelope(eventlist, &last_delta, &errors);
+      if (nevents < 0) return;
+      events = eventlist;
+      /* envelopes which produced messages are not kept, so that */
+      /* the messages are repeated for every note as before      */
+      if (!errors) {
+        env = &envcache[envnext];
+        if (envnext < envcached) {
+          free(env->events);
+        } else {
+          envcached++;
+        };
+        envnext = (envnext + 1) % ENVCACHESIZE;
+        env->duration = delta_time;
+        env->nevents = nevents;
+        env->last_delta = last_delta;
+        env->events = (struct eventstruc *)
+                       malloc((nevents+1)*sizeof(struct eventstruc));
+        if (env->events == NULL) {
+          event_fatal_error("Out of memory for note effects");
+        };
+        memcpy(env->events, eventlist, nevents*sizeof(struct eventstruc));
+      };
+    };
+    output_eventlist(events,nevents,chan);
 
-    /* [SS] 2015-08-28 */
-    last_delta = delta - eventlist[j-1].time; /* [SS] 2017-06-10 */
     midi_noteoff(last_delta, Q[Qhead].pitch, Q[Qhead].chan);
 
     for (layer=0;layer <= nlayers;layer++) {
@@ -5,7 +5,8 @@
 /* Notes due to finish in the future are held in a queue (linked list)
  * in time order. Qhead points to the head of the list and addtoQ() 
  * adds a note to the list. The unused elements of array Q are held
- * in another linked list pointed to by freehead. The tail is pointed
+ * in another linked list pointed to by freehead; Q grows when this
+ * list runs out, up to QMAXSIZE elements. The tail is pointed
  * to by freetail. removefromQ() removes an element (always from the
  * head of the list) and adds it to the free list. Qinit() initializes
  * the queue and clearQ() outputs all the remaining notes at the end
@@ -46,6 +46,7 @@ void clearvoicecontexts()
 int getchordnumbers()
 void addchordname()
 void setup_chordnames()
+void open_midi_stdout()
 void event_init()
 void event_text()
 void event_x_reserved()
@@ -68,6 +69,8 @@ int autoextend()
 int textextend()
 void addfeature()
 void replacefeature()
+void movefeatures()
+void insertfeatures()
 void insertfeature()
 void removefeature()
 void removefeatures()
@@ -177,9 +180,11 @@ void convert_tnote_to_note()
 void expand_ornaments()
 void fix_part_start()
 void finishfile()
+int jobselect()
 void event_blankline()
 void event_refno()
 void event_eof()
+int spawn_jobs()
 int main()
 
 
@@ -224,6 +229,16 @@ int setOutFileCreator(char *fileName,unsigned long theType,
 #define strchr index
 #endif
 
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#else
+#include <io.h>
+#include <fcntl.h>
+#endif
+
 #ifdef ANSILIBS
 #include <string.h>
 #include <stdlib.h>
@@ -243,6 +258,7 @@ int load_stress_parameters(char *);
 /* global variables grouped roughly by function */
 
 FILE *fp;
+FILE *midistdout = NULL; /* [SS] 2026-10-18 for -o - */
 FILE *diaghandle; /* [SS] 2019-03-20 */
 int done_with_barloc = 0; /* [SS] 2019-03-21 */
 
@@ -297,6 +313,13 @@ int bend = 8192; /* [SS] 2012-04-01 */
 int comma53 = 0; /* [SS] 2014-01-12 */
 int silent = 0; /* [SS] 2014-10-16 */
 int error_count = 0; /* number of errors reported by event_error() [RK] 2026-03-30 */
+/* [SS] 2026-10-18 -j option: tunes are shared out between worker processes */
+int jobs = 1;     /* number of worker processes */
+int jobfirst = 0; /* first tune converted by this worker, counting from 0 */
+int joblast = -1; /* tune following the last one converted or -1 */
+int jobtune = 0;  /* number of X: fields encountered so far */
+int jobout = -1;  /* where this worker collects its messages */
+int jobnull = -1; /* where messages about other workers' tunes go */
 int no_more_free_channels; /* [SS] 2015-03-23 */
 void init_p48toc53 (); /* [SS] 2014-01-12 */ 
 void convert_to_comma53 (char acc, int *midipitch, int* midibend);  
@@ -385,6 +408,8 @@ int splitdepth = 0;
 /* storage structure for strings */
 int maxtexts = INITTEXTS;
 char** atext;
+/* [SS] 2026-10-18 atext[] and words[] point into textarena */
+static struct stringarena textarena;
 int ntexts = 0;
 
 /* Named guitar chords */
@@ -876,6 +901,34 @@ static void setup_chordnames()
   addchordname("5", 2, list_5);
 }
 
+static void open_midi_stdout()
+/* [SS] 2026-10-18 -o - writes the MIDI file to standard output. */
+/* All messages are printed with printf, so the original standard */
+/* output is kept for the MIDI data and stdout is redirected to   */
+/* stderr.                                                        */
+{
+  int fd;
+
+  fflush(stdout);
+#ifndef _WIN32
+  fd = dup(fileno(stdout));
+  if (fd == -1 || (midistdout = fdopen(fd, "wb")) == NULL) {
+    event_fatal_error("Cannot write MIDI file to standard output");
+  };
+  dup2(fileno(stderr), fileno(stdout));
+#else
+  fd = _dup(_fileno(stdout));
+  if (fd == -1) {
+    event_fatal_error("Cannot write MIDI file to standard output");
+  };
+  _setmode(fd, _O_BINARY);
+  if ((midistdout = _fdopen(fd, "wb")) == NULL) {
+    event_fatal_error("Cannot write MIDI file to standard output");
+  };
+  _dup2(_fileno(stderr), _fileno(stdout));
+#endif
+}
+
 void event_init(int argc, char *argv[], char **filename)
 /* this routine is called first by parseabc.c */
 {
@@ -1012,6 +1065,17 @@ void event_init(int argc, char *argv[], char **filename)
   if (getarg("-OCC",argc,argv) != -1) oldchordconvention=1;
   if (getarg("-silent",argc,argv) != -1) silent = 1; /* [SS] 2014-10-16 */
 
+  arg = getarg("-j",argc,argv); /* [SS] 2026-10-18 */
+  if (arg != -1) {
+    if (argc > arg) {
+      n = sscanf(argv[arg],"%d",&m);
+      if (n > 0 && m > 0) jobs = m;
+      else event_error("-j expects a number of worker processes");
+    } else {
+      event_error("No number given, ignoring -j option");
+    };
+  };
+
   maxnotes = 500;
   /* allocate space for notes */
   pitch = checkmalloc(maxnotes*sizeof(int));
@@ -1030,16 +1094,18 @@ void event_init(int argc, char *argv[], char **filename)
   /* and for text */
   atext = (char**) checkmalloc(maxtexts*sizeof(char*));
   words = (char**) checkmalloc(maxwords*sizeof(char*));
+  initarena(&textarena); /* [SS] 2026-10-18 */
   if ((getarg("-h", argc, argv) != -1) || (argc < 2)) {
     printf("abc2midi version %s\n",VERSION);
     printf("Usage : abc2midi <abc file> [reference number] [-c] [-v] ");
     printf("[-o filename]\n");
     printf("        [-t] [-n <value>] [-CS] [-NFNP] [-NCOM] [-NFER] [-NGRA] [-NGUI] [-HARP] [-PMAR]\n");
+    printf("        [-j <number>]\n");
     printf("        [reference number] selects a tune\n");
     printf("        -c  selects checking only\n");
     printf("        -v  selects verbose option\n");
     printf("        -ver prints version number and exits\n");
-    printf("        -o <filename>  selects output filename\n");
+    printf("        -o <filename>  selects output filename (- for stdout)\n");
     printf("        -t selects filenames derived from tune titles\n");
     printf("        -n <limit> set limit for length of filename stem\n");
     printf("        -CS use 2:1 instead of 3:1 for broken rhythms\n"); /* [SS] 2016-01-02 */
@@ -1058,6 +1124,7 @@ void event_init(int argc, char *argv[], char **filename)
     printf("        -OCC old chord convention (eg. +CE+)\n");
     printf("        -TT tune to A =  <frequency>\n");
     printf("        -CSM <filename> load custom stress models from file\n");
+    printf("        -j <number> convert the tunes using <number> processes\n");
     printf(" The default action is to write a MIDI file for each abc tune\n");
     printf(" with the filename <stem>N.mid, where <stem> is the filestem\n");
     printf(" of the abc file and N is the tune reference number. If the -o\n");
@@ -1125,6 +1192,9 @@ outbase = addstring(argv[1]); /* [RM] 2010-11-21 */
         event_warning("-o option over-rides -t option");
         titlenames = 0;
       };
+      if (strcmp(outname, "-") == 0) {
+        open_midi_stdout();
+      };
     } else {
       event_error("No filename given, ignoring -o option");
     };
@@ -1538,29 +1608,13 @@ void event_error(char *s)
 /* generic error handler */
 {
   error_count++; /* [RK] 2026-03-30 */
-#ifdef NOFTELL
-  extern int nullpass;
-
-  if (nullpass != 1) {
-    printf("Error in line-char %d-%d : %s\n", lineno,lineposition, s);
-  };
-#else
   printf("Error in line-char %d-%d : %s\n", lineno, lineposition, s);
-#endif
 }
 
 void event_warning(char *s)
 /* generic warning handler - for flagging possible errors */
 {
-#ifdef NOFTELL
-  extern int nullpass;
-
-  if (nullpass != 1) {
-    printf("Warning in line-char %d-%d : %s\n", lineno,lineposition, s);
-  };
-#else
   printf("Warning in line-char %d-%d : %s\n", lineno, lineposition, s);
-#endif
 }
 
 static int autoextend(int maxnotes)
@@ -1677,48 +1731,53 @@ static void replacefeature(int f, int p, int n, int d, int loc)
 }
 
 
-void insertfeature(int f, int p, int n, int d, int loc)
-/* insert feature in internal table */
-{ int i;
-  notes = notes + 1;
-  if (notes >= maxnotes) {
+static void movefeatures(int from, int to, int count)
+/* [SS] 2026-10-18 moves count entries of the feature table from */
+/* position from to position to. The areas may overlap. One      */
+/* memmove per array replaces the element by element loops.      */
+{
+  if (count <= 0) return;
+  memmove(&feature[to], &feature[from], count*sizeof(featuretype));
+  memmove(&pitch[to], &pitch[from], count*sizeof(int));
+  memmove(&num[to], &num[from], count*sizeof(int));
+  memmove(&denom[to], &denom[from], count*sizeof(int));
+  memmove(&pitchline[to], &pitchline[from], count*sizeof(int));
+  memmove(&bentpitch[to], &bentpitch[from], count*sizeof(int));
+  memmove(&decotype[to], &decotype[from], count*sizeof(int)); /* [SS] 2012-06-29 */
+  memmove(&charloc[to], &charloc[from], count*sizeof(int)); /* [SS] 2014-12-25 */
+}
+
+static void insertfeatures(int loc, int count)
+/* [SS] 2026-10-18 opens a gap of count entries at loc in the  */
+/* feature table. The new entries are filled in by the caller  */
+/* with replacefeature(). Making room for several features at  */
+/* once moves the rest of the table only once.                 */
+{
+  int i;
+
+  notes = notes + count;
+  while (notes >= maxnotes) {
     maxnotes = autoextend(maxnotes);
   };
-  for (i=notes;i>loc;i--) {
-    feature[i] = feature[i-1];
-    pitch[i] = pitch[i-1];
-    pitchline[i] = pitchline[i-1];
-    bentpitch[i] = bentpitch[i-1];
-    decotype[i] = decotype[i-1]; /* [SS] 2012-06-29 */
-    charloc[i] = charloc[i-1]; /* [SS] 2014-12-25 */
-    num[i] = num[i-1];
-    denom[i] = denom[i-1];
-    };
-  feature[loc] = f;
-  pitch[loc]   = p;
-  num[i]       = n;
-  denom[i]     = d;
-  pitchline[i] = 0;
-  charloc[i] = lineposition; /* [SS] 2014-12-25 */
-  bentpitch[i] = 0;
-  decotype[i] = 0;
+  movefeatures(loc, loc+count, notes-count-loc+1);
+  for (i=loc; i<loc+count; i++) {
+    pitchline[i] = 0;
+    charloc[i] = lineposition; /* [SS] 2014-12-25 */
+    bentpitch[i] = 0;
+    decotype[i] = 0;
+  };
 }
 
-static void removefeature(int loc)
+void insertfeature(int f, int p, int n, int d, int loc)
+/* insert feature in internal table */
 {
-  int i;
-  for (i=loc;i<notes;i++)
-    {
-    feature[i] = feature[i+1];
-    pitch[i]   = pitch[i+1];
-    num[i]     = num[i+1];
-    denom[i]   = denom[i+1];
-    pitchline[i] = pitchline[i+1];
-    bentpitch[i] = bentpitch[i+1];
-    decotype[i] = decotype[i+1]; /* [SS] 2012-06-29 */
-    charloc[i] = charloc[i+1]; /* [SS] 2014-12-25 */
+  insertfeatures(loc, 1);
+  replacefeature(f, p, n, d, loc);
+}
 
-    }
+static void removefeature(int loc)
+{
+  movefeatures(loc+1, loc, notes-loc);
   notes--;
 }
 
@@ -1756,20 +1815,9 @@ charloc[loc1] = tcharloc;
 
 static void removefeatures(int locfrom, int locto)
 {
-  int i;
   int offset;
   offset = locto - locfrom + 1;
-  for (i=locfrom;i<notes;i++)
-    {
-    feature[i] = feature[i+offset];
-    pitch[i]   = pitch[i+offset];
-    num[i]     = num[i+offset];
-    denom[i]   = denom[i+offset];
-    pitchline[i] = pitchline[i+offset];
-    bentpitch[i] = bentpitch[i+offset];
-    decotype[i] = decotype[i+offset]; /* [SS] 2014-11-09 */
-    charloc[i]  = charloc[i+offset]; /* [SS] 2014-12-25 */
-    }
+  movefeatures(locto+1, locfrom, notes-locto); /* [SS] 2026-10-18 */
   notes -= offset;
 }
 
@@ -1800,7 +1848,7 @@ static void textfeature(int type, char *s)
 /* called while parsing abc - stores an item which requires an */
 /* associared string */
 {
-  atext[ntexts] = addstring(s);
+  atext[ntexts] = arenastring(&textarena, s); /* [SS] 2026-10-18 */
   addfeature(type, ntexts, 0, 0);
   ntexts = ntexts + 1;
   if (ntexts >= maxtexts) {
@@ -1916,11 +1964,13 @@ void event_midi(char *s)
     char command[40];
     char *p;
     int done;
+    int code;
 
     p = s;
     done = 0;
     skipspace(&p);
     readstr(command, &p, 40);
+    code = midi_command_code(command); /* [SS] 2026-10-18 */
 
     if (s[0] == '=') {
      event_warning("Do not use MIDI= in I: command. Just use MIDI");
@@ -1929,7 +1979,7 @@ void event_midi(char *s)
 
     if (verbose > 1) printf("event_midi command: %s\n",command);
 
-    if (strcmp(command, "channel") == 0) {
+    if (code == MIDI_CHANNEL) {
       skipspace(&p);
       ch = readnump(&p) - 1;
       if (v != NULL) {
@@ -1948,7 +1998,7 @@ void event_midi(char *s)
       done = 1;
     }
 
-    else if ((strcmp(command,"transpose") == 0) || (strcmp(command,"rtranspose") == 0)) {
+    else if ((code == MIDI_TRANSPOSE) || (code == MIDI_RTRANSPOSE)) {
       int neg, val;
 
       skipspace(&p);
@@ -1962,7 +2012,7 @@ void event_midi(char *s)
       val = readnump(&p);
       if (neg) val = - val;
 
-        if (strcmp(command,"transpose") == 0) {
+        if (code == MIDI_TRANSPOSE) {
           addfeature(GTRANSPOSE, val, 0, 0);
         } else {
           addfeature(RTRANSPOSE, val, 0, 0);
@@ -1970,7 +2020,7 @@ void event_midi(char *s)
       done = 1;
     }
 
-    else if (strcmp(command, "C") == 0) {
+    else if (code == MIDI_C) {
       int val;
 
       skipspace(&p);
@@ -1980,7 +2030,7 @@ void event_midi(char *s)
     }
 
     /* [SS] 2017-06-02 */
-    else if (strcmp(command,"programbase") == 0) {
+    else if (code == MIDI_PROGRAMBASE) {
       int val;
       skipspace(&p);
       val = readnump(&p);
@@ -1990,28 +2040,28 @@ void event_midi(char *s)
       }
 
 
-    else if (strcmp(command, "nobarlines") == 0) {
+    else if (code == MIDI_NOBARLINES) {
      propagate_accidentals = 0; /* [SS] 2015-08-18 */
       done = 1;
     }
 
-    else if (strcmp(command, "barlines") == 0) {
+    else if (code == MIDI_BARLINES) {
       propagate_accidentals = 2; /* [SS] 2015-08-18 */
       done = 1;
     }
 
-    else if (strcmp(command, "fermatafixed") == 0) {
+    else if (code == MIDI_FERMATAFIXED) {
       fermata_fixed = 1;
       done = 1;
     }
 
-    else if (strcmp(command, "fermataproportional") == 0) {
+    else if (code == MIDI_FERMATAPROPORTIONAL) {
       fermata_fixed = 0;
       done = 1;
     }
 
     /* [SS] 2014-01-12 */
-    else if (strcmp(command, "tuningsystem") == 0) {
+    else if (code == MIDI_TUNINGSYSTEM) {
       skipspace(&p);
       if (strcmp(p,"comma53") == 0) {
         printf("%s\n",p);
@@ -2024,7 +2074,7 @@ void event_midi(char *s)
         }
     }
 
-    else if (strcmp(command, "ratio") == 0) {
+    else if (code == MIDI_RATIO) {
       int a, b;
       skipspace(&p);
       b = readnump(&p);
@@ -2043,7 +2093,7 @@ void event_midi(char *s)
       done = 1;
     }
 
-    else if (strcmp(command, "grace") == 0) {
+    else if (code == MIDI_GRACE) {
       int a, b;
       char msg[200];
       skipspace(&p);
@@ -2068,7 +2118,7 @@ void event_midi(char *s)
       done = 1;
     }
 
-    else if(strcmp(command,"gracedivider") == 0) {
+    else if(code == MIDI_GRACEDIVIDER) {
       int b;
       char msg[200];
       skipspace(&p);
@@ -2086,7 +2136,7 @@ void event_midi(char *s)
     }
 
 
-    else if (strcmp(command, "trim") == 0) {
+    else if (code == MIDI_TRIM) {
       int a, b;
       skipspace(&p);
       a = readnump(&p);
@@ -2108,7 +2158,7 @@ void event_midi(char *s)
     }
 
     /* [SS] 2015-06-16 */
-    else if (strcmp(command, "expand") == 0) {
+    else if (code == MIDI_EXPAND) {
       int a, b;
       skipspace(&p);
       a = readnump(&p);
@@ -2130,17 +2180,17 @@ void event_midi(char *s)
     }
 
 
-    else if (strcmp(command, "gchordon") == 0) {
+    else if (code == MIDI_GCHORDON) {
       addfeature(GCHORDON, 0, 0, 0);
       done = 1;
     }
 
-    else if (strcmp(command, "gchordoff") == 0) {
+    else if (code == MIDI_GCHORDOFF) {
       addfeature(GCHORDOFF, 0, 0, 0);
       done = 1;
     }
 
-    else if (strcmp(command, "chordname") == 0) {
+    else if (code == MIDI_CHORDNAME) {
       char name[20];
       int i, notes[10]; /* [SS] 2012-01-29 */
 
@@ -2167,7 +2217,7 @@ void event_midi(char *s)
     }
 
 
-  else if (strcmp(command, "temperamentlinear") == 0) {
+  else if (code == MIDI_TEMPERAMENTLINEAR) {
       double octave_cents=0.0;
       double fifth_cents=0.0;
       temperament = TEMPERLN;
@@ -2202,7 +2252,7 @@ void event_midi(char *s)
     }
 
   /* [HL] 2015-05-15 */
-  else if (strcmp(command, "temperamentequal") == 0) {
+  else if (code == MIDI_TEMPERAMENTEQUAL) {
       double octave_cents;
       float acc_size = -1.0;  /* [SDG] 2020-06-03 */
       int narg, ndiv, fifth_index, sharp_steps;
@@ -2285,7 +2335,7 @@ void event_midi(char *s)
       done = 1;
     }
 
-  else if (strcmp(command, "temperamentnormal") == 0) {
+  else if (code == MIDI_TEMPERAMENTNORMAL) {
       temperament = TEMPERNORMAL;
       event_normal_tone();
       done = 1;
@@ -2293,19 +2343,19 @@ void event_midi(char *s)
       }
 
 
-  else if (strcmp(command,"drumon") == 0 && dotune) {  /* [SS] 2010-05-26 */
+  else if (code == MIDI_DRUMON && dotune) {  /* [SS] 2010-05-26 */
       if (v == NULL) event_fatal_error("%%MIDI drumon must occur after the first K: header");
       addfeature(DRUMON, 0, 0, 0);
       v->hasdrums = 1;
       drumvoice = v->indexno; /* [SS] 2010-02-09 */
       done = 1;
     }
-    if (strcmp(command,"drumoff") == 0) {
+    if (code == MIDI_DRUMOFF) {
        addfeature(DRUMOFF, 0, 0, 0);
        done = 1;
     }
 
-  else if (strcmp(command,"droneon") == 0 && dotune) {
+  else if (code == MIDI_DRONEON && dotune) {
       addfeature(DRONEON, 0, 0, 0);
       v->hasdrone = 1;
       if ((dronevoice != 0) && (dronevoice != v->indexno)) {
@@ -2318,24 +2368,24 @@ void event_midi(char *s)
            }
     }
 
-  else if (strcmp(command,"droneoff") == 0) {
+  else if (code == MIDI_DRONEOFF) {
        addfeature(DRONEOFF, 0, 0, 0);
        done = 1;
     }
 
-  else if (strcmp(command, "deltaloudness") == 0) {
+  else if (code == MIDI_DELTALOUDNESS) {
       skipspace(&p);
       velocitychange = readnump(&p);
       done = 1;
       }
-	if (strcmp(command, "harpmode") == 0) {  /* [JS] 2011-04-29 */
+	if (code == MIDI_HARPMODE) {  /* [JS] 2011-04-29 */
       skipspace(&p);
       harpmode = readnump(&p);
       done = 1;
     }
 
 /* [SS] 2018-04-16 originally in dodeferred */
-  else if (strcmp(command,"ptstress") == 0) {  /* [SS] 2011-07-04 */
+  else if (code == MIDI_PTSTRESS) {  /* [SS] 2011-07-04 */
      char inputfile[256]; /* [SS] 2011-07-04 */
      skipspace(&p);
      strncpy(inputfile,p,250);
@@ -2519,6 +2569,7 @@ void event_specific_in_header(char *package, char *s)
   char  command[40];
   char *p;
   int done;
+  int code;
 
   if (strcmp(package, "MIDI") == 0) {
 
@@ -2526,10 +2577,11 @@ void event_specific_in_header(char *package, char *s)
     done = 0;
     skipspace(&p);
     readstr(command, &p, 40);
+    code = midi_command_code(command); /* [SS] 2026-10-18 */
 
 
 
-    if (strcmp(command, "C") == 0) {
+    if (code == MIDI_C) {
       int val;
 
       skipspace(&p);
@@ -2537,28 +2589,28 @@ void event_specific_in_header(char *package, char *s)
       default_middle_c = val;
       done = 1;
     };
-    if (strcmp(command, "nobarlines") == 0) {
+    if (code == MIDI_NOBARLINES) {
       default_retain_accidentals = 0;
       done = 1;
     };
-    if (strcmp(command, "barlines") == 0) {
+    if (code == MIDI_BARLINES) {
       default_retain_accidentals = 2;
       done = 1;
     };
-    if (strcmp(command, "fermatafixed") == 0) {
+    if (code == MIDI_FERMATAFIXED) {
       default_fermata_fixed = 1;
       done = 1;
     };
-    if (strcmp(command, "fermataproportional") == 0) {
+    if (code == MIDI_FERMATAPROPORTIONAL) {
       default_fermata_fixed = 0;
       done = 1;
     };
-    if (strcmp(command, "harpmode") == 0) {  /* [JS] 2011-04-29 */
+    if (code == MIDI_HARPMODE) {  /* [JS] 2011-04-29 */
       skipspace(&p);
       harpmode = readnump(&p);
       done = 1;
     };
-    if (strcmp(command, "ratio") == 0) {
+    if (code == MIDI_RATIO) {
       int a, b;
       skipspace(&p);
       b = readnump(&p);
@@ -2577,7 +2629,7 @@ void event_specific_in_header(char *package, char *s)
       done = 1;
     };
 
-    if (strcmp(command, "chordname") == 0) {
+    if (code == MIDI_CHORDNAME) {
       char name[20];
       int i, notes[6];
       skipspace(&p);
@@ -2603,13 +2655,13 @@ void event_specific_in_header(char *package, char *s)
     };
 
 
-    if (strcmp(command, "deltaloudness") == 0) {
+    if (code == MIDI_DELTALOUDNESS) {
       skipspace(&p);
       velocitychange = readnump(&p);
       done = 1;
       }
 
-    if (strcmp(command,"drummap") == 0) { /* [SS] 2017-12-10 */
+    if (code == MIDI_DRUMMAP) { /* [SS] 2017-12-10 */
       skipspace(&p);
       parse_drummap(&p);
       done = 1;
@@ -2735,7 +2787,7 @@ void event_words(char *p, int append, int continuation)
     }
   v->haswords = 1;
   wordvoice = v->indexno;
-  words[wcount] = addstring(p);
+  words[wcount] = arenastring(&textarena, p); /* [SS] 2026-10-18 */
   if ((append == PLUS_FIELD) || (append == W_PLUS_FIELD)) {
     addfeature(WORDEXTEND, 0, 0, 0);
   };
@@ -2753,7 +2805,7 @@ void event_words(char *p, int append, int continuation)
 void append_words (char *morewords)
 {
 char *p;
-p = concatenatestring(words[wcount-1],morewords);
+p = arenaconcat(&textarena, words[wcount-1], morewords); /* [SS] 2026-10-18 */
 words[wcount-1] = p;
 }
 
@@ -3921,17 +3973,18 @@ a = n*4;
 b = m*default_length*5;
 reduce(&a,&b);
 replacefeature(NOTE, pitch, a, b,i);
+insertfeatures(i+1, 4); /* [SS] 2026-10-18 */
 i++;
-insertfeature(NOTE, pitchup, a, b,i);
+replacefeature(NOTE, pitchup, a, b,i);
 bentpitch[i] = bend_up;
 i++;
-insertfeature(NOTE, pitch, a, b,i);
+replacefeature(NOTE, pitch, a, b,i);
 bentpitch[i] = active_pitchbend;
 i++;
-insertfeature(NOTE, pitchdown, a, b,i);
+replacefeature(NOTE, pitchdown, a, b,i);
 bentpitch[i] = bend_down;
 i++;
-insertfeature(NOTE, pitch, a, b,i);
+replacefeature(NOTE, pitch, a, b,i);
 bentpitch[i] = active_pitchbend;
 }
 
@@ -4038,14 +4091,15 @@ removefeature(i);
   };
   j = 0;
 reduce(&a,&b);
+  insertfeatures(i, count); /* [SS] 2026-10-18 */
   while (j < count) {
     /*if (i == count - 1) {  **bug** [SS] 2006-09-10 */
     if (j%2 == 0) {
-      insertfeature(NOTE, pitchup, a, b,i);
+      replacefeature(NOTE, pitchup, a, b,i);
       bentpitch[i] = bend;
       i++;
     } else {
-      insertfeature(NOTE, pitch, a, b,i);
+      replacefeature(NOTE, pitch, a, b,i);
       bentpitch[i] = active_pitchbend;
       i++;
     };
@@ -5750,6 +5804,7 @@ static void startfile()
   set_drums("z");
   drumvoice = 0;
   wordvoice = 0;
+  dronevoice = 0; /* [SS] 2026-10-18 */
   notesdefined = 1; /* [SS] 2012-07-02 */
   rhythmdesignator[0] = '\0'; /* [SS] 2015-12-31 */
   stress_pattern_loaded = 0; /* [SS] 2018-04-16 */
@@ -6126,6 +6181,8 @@ static void finishfile()
     if (parts >= 0) fix_part_start(); /* [SS] 2012-12-25 */
     if (verbose > 5) dumpfeat(0,notes);
 
+    compile_deferred(); /* [SS] 2026-10-18 */
+    index_voices(); /* [SS] 2026-10-18 */
     if (check) {
       Mf_putc = &nullputc;
       header_time_num = time_num; /* [SS] 2010-05-21 */
@@ -6149,7 +6206,9 @@ static void finishfile()
         }
       } /* more than 1 track */
     } else {    /* check != 0 */
-      if ((fp = fopen(outname, "wb")) == NULL) {
+      if (midistdout != NULL) {
+        fp = midistdout;
+      } else if ((fp = fopen(outname, "wb")) == NULL) {
         event_fatal_error("File open failed");
       };
       if (!silent) printf("writing MIDI file %s\n", outname);
@@ -6162,21 +6221,64 @@ static void finishfile()
       } else {
         mfwrite(1, ntracks, division, fp);
       };
-      fclose(fp);
+      if (fp == midistdout) {
+        fflush(fp);
+      } else {
+        fclose(fp);
+      };
 #ifdef __MACINTOSH__
       (void) setOutFileCreator(outname,'Midi','ttxt');
 #endif /* __MACINTOSH__ */
 
     };
-    for (i=0; i<ntexts; i++) {
-      free(atext[i]);
-    };
-    for (i=0; i<wcount; i++) {
-      free(words[i]);
-    };
+    free_deferred(); /* [SS] 2026-10-18 */
+    free_voice_index();
     freevstring(&part);
     free_notestructs(); /* [SS] 2012-06-03 */ 
   };
+  cleararena(&textarena); /* [SS] 2026-10-18 releases atext[] and words[] */
+}
+
+#ifndef _WIN32
+static void jobredirect(int fd)
+/* sends anything printed from now on to fd */
+{
+  fflush(stdout);
+  dup2(fd, 1);
+}
+#endif
+
+static void close_jobnull()
+/* [SS] 2026-10-18 closes the /dev/null descriptor opened by */
+/* spawn_jobs() once this process has converted its tunes    */
+{
+#ifndef _WIN32
+  if (jobnull != -1) {
+    fflush(stdout);
+    close(jobnull);
+    jobnull = -1;
+  };
+#endif
+}
+
+int jobselect()
+/* [SS] 2026-10-18 called by event_refno() for every X: field when  */
+/* the tunes are shared out between worker processes. Returns 1 if  */
+/* the tune belongs to this worker. Only the messages issued while  */
+/* this worker's tunes are being converted are collected, so that   */
+/* the combined output of the workers matches a single process.     */
+{
+  int tune;
+
+  tune = jobtune;
+  jobtune = jobtune + 1;
+#ifndef _WIN32
+  if ((tune == jobfirst) && (jobfirst > 0)) jobredirect(jobout);
+  if (tune == joblast) jobredirect(jobnull);
+#endif
+  if (tune < jobfirst) return 0;
+  if ((joblast != -1) && (tune >= joblast)) return 0;
+  return 1;
 }
 
 void event_blankline()
@@ -6204,6 +6306,7 @@ void event_refno(int n)
     parseroff();
     dotune = 0;
   };
+  if ((jobs > 1) && (jobselect() == 0)) return; /* [SS] 2026-10-18 */
   if ((n == xmatch) || (xmatch == 0) || (xmatch == -1)) {
     if (xmatch == -1) {
       xmatch = -2;
@@ -6270,6 +6373,139 @@ void event_eof()
   free(outbase);
 }
 
+#ifndef _WIN32
+static int compare_xrefs(const void *a, const void *b)
+{
+  return ((const struct abctune *) a)->xref - ((const struct abctune *) b)->xref;
+}
+#endif
+
+int spawn_jobs(char *filename)
+/* [SS] 2026-10-18 implements the -j option. The tunes of the file */
+/* are split at the X: fields into runs of roughly equal size and  */
+/* each run is converted by a separate process. The messages from  */
+/* the workers are collected in temporary files and printed in the */
+/* order of the tunes once all of them have finished. Returns 1 in */
+/* the controlling process when the file has been converted and 0  */
+/* in the workers, or if the file cannot be split, in which case   */
+/* the caller goes on to convert the tunes itself.                 */
+{
+#ifdef _WIN32
+  event_warning("-j is not supported on this platform");
+  return 0;
+#else
+  struct abcbuffer source;
+  struct abctune *tunes, *sorted;
+  int ntunes;
+  int *first;
+  pid_t *pid;
+  FILE **collect;
+  long total, size;
+  int i, w, nworkers, status;
+  char buffer[4096];
+  size_t got;
+
+  if ((xmatch != 0) || (titlenames == 1)) return 0;
+  if ((strcmp(filename, "stdin") == 0) || (strcmp(filename, "-") == 0)) {
+    return 0;
+  };
+  if (openabcbuffer(filename, &source) == 0) return 0;
+  tunes = indexabcbuffer(&source, &ntunes);
+  total = source.len;
+  freeabcbuffer(&source);
+  if (ntunes < 2) {
+    free(tunes);
+    return 0;
+  };
+  /* tunes sharing a reference number write to the same file, so  */
+  /* they must be converted in file order by a single process.    */
+  sorted = (struct abctune *) checkmalloc(ntunes*sizeof(struct abctune));
+  memcpy(sorted, tunes, ntunes*sizeof(struct abctune));
+  qsort(sorted, ntunes, sizeof(struct abctune), compare_xrefs);
+  for (i = 1; i < ntunes; i++) {
+    if (sorted[i].xref == sorted[i-1].xref) break;
+  };
+  free(sorted);
+  if (i < ntunes) {
+    event_warning("repeated X: reference numbers, ignoring -j option");
+    free(tunes);
+    return 0;
+  };
+
+  /* first[w] is the first tune of worker w; the boundaries are */
+  /* chosen so that each worker gets about the same amount of abc */
+  if (jobs > ntunes) jobs = ntunes;
+  first = (int *) checkmalloc((jobs+1)*sizeof(int));
+  size = total - tunes[0].offset;
+  first[0] = 0;
+  nworkers = 1;
+  for (i = 1; i < ntunes; i++) {
+    if ((tunes[i].offset - tunes[0].offset) * (long) jobs >= size * (long) nworkers) {
+      first[nworkers] = i;
+      nworkers = nworkers + 1;
+      if (nworkers == jobs) break;
+    };
+  };
+  first[nworkers] = -1;
+  free(tunes);
+
+  pid = (pid_t *) checkmalloc(nworkers*sizeof(pid_t));
+  collect = (FILE **) checkmalloc(nworkers*sizeof(FILE *));
+  fflush(stdout);
+  for (w = 0; w < nworkers; w++) {
+    collect[w] = tmpfile();
+    pid[w] = -1;
+    if (collect[w] != NULL) pid[w] = fork();
+    if (pid[w] == 0) {
+      /* worker process */
+      jobfirst = first[w];
+      joblast = first[w+1];
+      jobout = fileno(collect[w]);
+      jobnull = open("/dev/null", O_WRONLY);
+      if (jobfirst > 0) jobredirect(jobnull);
+      else jobredirect(jobout);
+      free(first);
+      free(pid);
+      free(collect);
+      return 0;
+    };
+    if (pid[w] == -1) {
+      if (collect[w] != NULL) fclose(collect[w]);
+      break;
+    };
+  };
+
+  /* print the messages from the workers in order of the tunes */
+  for (i = 0; i < w; i++) {
+    waitpid(pid[i], &status, 0);
+    if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0)) error_count++;
+    fseek(collect[i], 0L, SEEK_SET);
+    while ((got = fread(buffer, 1, sizeof(buffer), collect[i])) > 0) {
+      fwrite(buffer, 1, got, stdout);
+    };
+    fclose(collect[i]);
+  };
+  fflush(stdout);
+  if (w < nworkers) {
+    /* could not start all the workers; convert the rest here */
+    event_warning("could not start worker process");
+    jobfirst = first[w];
+    joblast = -1;
+    jobnull = open("/dev/null", O_WRONLY);
+    jobout = dup(1);
+    jobredirect(jobnull);
+    free(first);
+    free(pid);
+    free(collect);
+    return 0;
+  };
+  free(first);
+  free(pid);
+  free(collect);
+  return 1;
+#endif
+}
+
 void set_control_defaults(); /* from queues.c */
 
 int main(int argc, char *argv[])
@@ -6290,7 +6526,10 @@ int main(int argc, char *argv[])
     init_abbreviations();
     init_drum_map(); /* [SS] 2017-12-10 */
     if (!silent) printf("%s\n",VERSION); /* [SS] 2015-07-15 */
-    parsefile(filename);
+    if ((jobs < 2) || (spawn_jobs(filename) == 0)) {
+      parsefile(filename);
+      close_jobnull();
+    };
     free_abbreviations();
   };
   return(error_count > 0 ? 1 : 0); /* [RK] 2026-03-30 */
@@ -1,11 +1,14 @@
 # Generic test runner for abcmidi golden-file tests.
 #
 # Required variables (passed via -D on the cmake command line):
-#   TYPE     - one of: abc2midi, abc2abc, midi2abc, midistats, mftext,
-#              yaps, midicopy, abcmatch
-#   SAMPLE   - path to the input ABC sample file
+#   TYPE     - one of: abc2midi, abc2midi_stdout, abc2midi_jobs, abc2abc, midi2abc,
+#              midistats, mftext, yaps, midicopy, abcmatch
+#   SAMPLE   - path to the input ABC sample file, or to a MIDI file (.mid)
+#              which is used as it is instead of being made by abc2midi
 #   GOLDEN   - path to the golden reference file
 #   TMPDIR   - working directory for temporary outputs
+#   TAG      - (optional) unique test name used for the temporary files;
+#              defaults to the name of the golden file
 #
 #   ABC2MIDI, ABC2ABC, MIDI2ABC, MIDISTATS, MFTEXT, YAPS, MIDICOPY, ABCMATCH
 #            - absolute paths to the binaries (only those needed for TYPE)
@@ -28,11 +31,17 @@ endif()
 
 file(MAKE_DIRECTORY "${TMPDIR}")
 
-# Derive a unique per-test tag from the golden file name (which equals the
-# unique test name).  Several tests share the same TYPE+SAMPLE (e.g. different
-# tunes of demo.abc all run abc2midi on demo.abc), so basing the temporary
-# file names on TYPE+sample would collide under parallel ctest.
-get_filename_component(tag "${GOLDEN}" NAME_WE)
+# Use a unique per-test tag for the temporary files: the test name when it
+# is passed as TAG, otherwise the golden file name (which normally equals
+# the test name).  Several tests share the same TYPE+SAMPLE (e.g. different
+# tunes of demo.abc all run abc2midi on demo.abc), and a test may compare
+# against another test's golden, so neither TYPE+sample nor GOLDEN alone is
+# guaranteed to be unique under parallel ctest.
+if(TAG)
+  set(tag "${TAG}")
+else()
+  get_filename_component(tag "${GOLDEN}" NAME_WE)
+endif()
 
 set(raw     "${TMPDIR}/${tag}.raw")
 set(out     "${TMPDIR}/${tag}.out")
@@ -98,10 +107,16 @@ endfunction()
 
 # Convert ${SAMPLE} to MIDI, then run ${bin} on the resulting MIDI file and
 # capture its stdout.  Any extra arguments are inserted BEFORE the MIDI path
-# (needed e.g. for "midi2abc -f <file>").
+# (needed e.g. for "midi2abc -f <file>").  A SAMPLE which is already a MIDI
+# file is used directly.
 function(run_via_mid outfile bin)
-  abc2midi_to_mid()
-  run_to_file("${outfile}" "${bin}" ${ARGN} "${midfile}")
+  if(SAMPLE MATCHES "\\.mid$")
+    set(input "${SAMPLE}")
+  else()
+    abc2midi_to_mid()
+    set(input "${midfile}")
+  endif()
+  run_to_file("${outfile}" "${bin}" ${ARGN} "${input}")
 endfunction()
 
 # Run ${bin} directly on ${SAMPLE} and capture its stdout.  Extra arguments
@@ -127,8 +142,50 @@ endif()
 if(TYPE MATCHES "^(abc2midi|mftext|midistats)$")
   run_via_mid("${raw}" "${bin}")
 
+elseif(TYPE STREQUAL "abc2midi_stdout")
+  # ABC -> MIDI on standard output (-o -) -> mftext
+  file(REMOVE "${midfile}")
+  execute_process(
+    COMMAND "${ABC2MIDI}" "${SAMPLE}" -o - -quiet -silent
+    OUTPUT_FILE "${midfile}"
+    RESULT_VARIABLE abc_rc
+    ERROR_VARIABLE  abc_err
+  )
+  if(NOT abc_rc EQUAL 0)
+    message(FATAL_ERROR
+      "abc2midi -o - failed for ${SAMPLE} (rc=${abc_rc}):\n"
+      "--- stderr ---\n${abc_err}")
+  endif()
+  run_to_file("${raw}" "${MFTEXT}" "${midfile}")
+
+elseif(TYPE STREQUAL "abc2midi_jobs")
+  # ABC -> MIDI with -j 2 -> mftext on the file of tune ABC2MIDI_TUNE.
+  # -j cannot be combined with -o, so abc2midi writes <stem><X>.mid
+  # beside its input; a copy of the sample in a directory of its own
+  # keeps those files out of the source tree.
+  set(jobdir "${TMPDIR}/${tag}")
+  get_filename_component(stem "${SAMPLE}" NAME_WE)
+  file(REMOVE_RECURSE "${jobdir}")
+  file(MAKE_DIRECTORY "${jobdir}")
+  configure_file("${SAMPLE}" "${jobdir}/${stem}.abc" COPYONLY)
+  execute_process(
+    COMMAND "${ABC2MIDI}" "${jobdir}/${stem}.abc" -j 2 -quiet -silent
+    RESULT_VARIABLE abc_rc
+    OUTPUT_VARIABLE abc_out
+    ERROR_VARIABLE  abc_err
+  )
+  set(tunemid "${jobdir}/${stem}${ABC2MIDI_TUNE}.mid")
+  if(NOT EXISTS "${tunemid}")
+    message(FATAL_ERROR
+      "abc2midi -j 2 produced no MIDI for tune ${ABC2MIDI_TUNE} of ${SAMPLE} "
+      "(rc=${abc_rc}):\n"
+      "--- stdout ---\n${abc_out}\n--- stderr ---\n${abc_err}")
+  endif()
+  run_to_file("${raw}" "${MFTEXT}" "${tunemid}")
+
 elseif(TYPE STREQUAL "midi2abc")
-  run_via_mid("${raw}" "${bin}" -f)
+  # MIDI2ABC_ARGS (possibly empty) forwards extra flags such as -stream.
+  run_via_mid("${raw}" "${bin}" ${MIDI2ABC_ARGS} -f)
 
 elseif(TYPE STREQUAL "abc2abc")
   run_on_sample("${raw}" "${bin}")
@@ -175,6 +232,10 @@ string(REGEX REPLACE "%%CreationDate:[^\n]*\n" "%%CreationDate: <stripped>\n" co
 # Strip absolute paths to TMPDIR (filenames embedded in some outputs)
 string(REPLACE "${TMPDIR}/" "" content "${content}")
 
+# midi2abc names its input file in the T: field; the temporary file name
+# depends on the test, and a MIDI SAMPLE lives in the source tree.
+string(REGEX REPLACE "\nT: from [^\n]*\n" "\nT: from <stripped>\n" content "${content}")
+
 file(WRITE "${out}" "${content}")
 
 # --- Update or compare -------------------------------------------------------
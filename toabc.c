@@ -144,6 +144,8 @@ struct abctext{ /* linked list used to store output before re-formatting */
 };
 struct abctext* head;
 struct abctext* tail;
+/* [SS] 2026-10-18 text and lyrics of the abctext list are held here */
+static struct stringarena textarena;
 
 
 extern int modekeyshift[];
@@ -295,10 +297,8 @@ static int flush_abctext(int bars, enum linestattype termination)
   foundbar = 0;
   while ((p != NULL) && (count < bars)) {
     if (p != NULL) {
-      free(p->text);
       q = p->lyrics;
       while (q != NULL) {
-        free(q->words);
         r = q->nextverse;
         free(q);
         q = r;
@@ -374,7 +374,7 @@ static struct abctext* newabctext(enum abctype t)
       this_voice = next_voice;
     };
     p = (struct abctext*) checkmalloc(sizeof(struct abctext));
-    p->text = addstring(tmp);
+    p->text = arenastring(&textarena, tmp); /* [SS] 2026-10-18 */
     tmp[0] = '\0';
     p->next = NULL;
     p->type = t;
@@ -597,6 +597,7 @@ void event_init(int argc, char *argv[], char **filename)
     newbreaks = 0;
   } else {
     newbreaks = 1;
+    initarena(&textarena); /* [SS] 2026-10-18 */
     if (narg >= argc) {
       event_error("No value for bars per line after -n");
       bars_per_line = 4;
@@ -764,6 +765,7 @@ static void close_newabc()
     complete_all(&voice[this_voice], endmusicline);
     if (linestat == midmusic) setline(endmusicline);
     setline(fresh);
+    cleararena(&textarena); /* [SS] 2026-10-18 */
   };
 }
 
@@ -961,7 +963,7 @@ void append_lyrics(struct abctext *place, char *newwords)
   new_words = (struct lyricwords*)checkmalloc(sizeof(struct lyricwords));
   /* add words to bar */
   new_words->nextverse = NULL;
-  new_words->words = addstring(newwords);
+  new_words->words = arenastring(&textarena, newwords); /* [SS] 2026-10-18 */
   if (place->lyrics == NULL) {
     place->lyrics = new_words;
   } else {